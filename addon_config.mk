@@ -88,6 +88,7 @@ linux64:
 	# linux only, any library that should be included in the project using
 	# pkg-config
 	# ADDON_PKG_CONFIG_LIBRARIES =
+	ADDON_LIBS += libs/fftw3f/lib/linux64/libfftw3f.a
 vs:
 	# After compiling copy the following dynamic libraries to the executable directory
 	# only windows visual studio
@@ -0,0 +1,519 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+// Checks the streaming descriptors against synthetic signals whose answer
+// is known. Each check builds an MLTKCore with the descriptor's flag on,
+// feeds it through audioIn()/run() in device sized blocks like an ofApp
+// would, and compares the events and pool values with the signal. The
+// fused paths are checked against the separate Essentia algorithms they
+// replace instead.
+//
+//   ./bin/mltkChecks [frontend|cepstrum|beat|onset|tonal|loudness|yin|segmenter|qc|all]
+//
+// Prints what each check measured and PASS or FAIL; exits with 1 if any
+// check failed.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "ofxMLTKCore.h"
+
+// What a run over a signal produced: the events, the Real and string pool
+// keys asked for with one value per hop, the vector keys with one vector
+// per hop and the newest QC.cpu
+struct Analysis {
+  vector<MLTKEvent> events;
+  map<string, vector<Real> > values;
+  map<string, vector<string> > labels;
+  map<string, vector<vector<Real> > > frames;
+  vector<Real> cpu;
+};
+
+static Analysis analyse(MLTKCore &mltk, const vector<Real> &signal, int frameSize, int sampleRate, int hopSize, const vector<string> &keys){
+  mltk.setup(frameSize, sampleRate, hopSize);
+
+  Analysis analysis;
+  const int blockSize = 256;
+  vector<float> block(blockSize);
+  for(size_t start = 0; start + blockSize <= signal.size(); start += blockSize){
+    copy(signal.begin() + start, signal.begin() + start + blockSize, block.begin());
+    const unsigned long long analysed = mltk.framesAnalyzed;
+    mltk.audioIn(&block[0], blockSize, 1);
+    mltk.run();
+
+    MLTKEvent event;
+    while(mltk.events.pop(event)) analysis.events.push_back(event);
+
+    // the pool keeps the last hop when run() had nothing new
+    if(mltk.framesAnalyzed == analysed) continue;
+    for(const string &key : keys){
+      if(mltk.pool.contains<vector<Real> >(key)){
+        const vector<Real> &v = mltk.pool.value<vector<Real> >(key);
+        analysis.values[key].insert(analysis.values[key].end(), v.begin(), v.end());
+      } else if(mltk.pool.contains<vector<vector<Real> > >(key)){
+        const vector<vector<Real> > &v = mltk.pool.value<vector<vector<Real> > >(key);
+        analysis.frames[key].insert(analysis.frames[key].end(), v.begin(), v.end());
+      } else if(mltk.pool.contains<vector<string> >(key)){
+        const vector<string> &v = mltk.pool.value<vector<string> >(key);
+        analysis.labels[key].insert(analysis.labels[key].end(), v.begin(), v.end());
+      }
+    }
+    if(mltk.pool.contains<vector<vector<Real> > >("QC.cpu")){
+      analysis.cpu = mltk.pool.value<vector<vector<Real> > >("QC.cpu").back();
+    }
+  }
+
+  mltk.exit();
+  return analysis;
+}
+
+// the time of the center of hop k's frame [s]
+static double frameTime(int k, int frameSize, int sampleRate, int hopSize){
+  return (k * hopSize + frameSize / 2.0) / sampleRate;
+}
+
+// pairs each event of the given type with the nearest unclaimed reference
+// time within tolerance; returns the matches and their mean distance
+static int match(const vector<MLTKEvent> &events, const char *type, const vector<double> &times, double tolerance, double after, int &found, double &error){
+  vector<bool> claimed(times.size(), false);
+  int matched = 0;
+  found = 0;
+  error = 0;
+  for(const MLTKEvent &e : events){
+    if(string(e.type) != type || e.time < after) continue;
+    found++;
+    int best = -1;
+    for(size_t j = 0; j < times.size(); j++){
+      if(claimed[j] || fabs(e.time - times[j]) > tolerance) continue;
+      if(best < 0 || fabs(e.time - times[j]) < fabs(e.time - times[best])) best = j;
+    }
+    if(best < 0) continue;
+    claimed[best] = true;
+    matched++;
+    error += fabs(e.time - times[best]);
+  }
+  if(matched > 0) error /= matched;
+  return matched;
+}
+
+static bool report(const string &name, bool pass){
+  cout << name << ": " << (pass ? "PASS" : "FAIL") << endl;
+  return pass;
+}
+
+// tones, a glide, noise bursts and a noise floor, something in every part
+// of the spectrum for the fused/separate comparisons
+static vector<Real> mixture(int sampleRate, double seconds){
+  std::mt19937 random(7);
+  std::normal_distribution<float> noise(0, 1);
+  vector<Real> signal((size_t) (seconds * sampleRate));
+  for(size_t i = 0; i < signal.size(); i++){
+    const double t = (double) i / sampleRate;
+    Real &x = signal[i];
+    for(int h = 1; h <= 6; h++) x += 0.2 / h * sin(2 * M_PI * 220 * h * t);
+    x += 0.1 * sin(2 * M_PI * (300 * t + 400 * t * t));
+    x += (fmod(t, 0.5) < 0.05 ? 0.3 : 0.01) * noise(random);
+  }
+  return signal;
+}
+
+// the largest difference between the frames of a key on two runs, relative
+// to the largest absolute value of the frame on the second run; a key
+// missing or with a different number of frames or bins gives infinity
+static double largestDifference(const Analysis &a, const Analysis &b, const string &key){
+  auto x = a.frames.find(key), y = b.frames.find(key);
+  if(x == a.frames.end() || y == b.frames.end() || x->second.empty() || x->second.size() != y->second.size()){
+    return INFINITY;
+  }
+  double largest = 0;
+  for(size_t k = 0; k < x->second.size(); k++){
+    const vector<Real> &u = x->second[k], &v = y->second[k];
+    if(u.size() != v.size()) return INFINITY;
+    double scale = 0, difference = 0;
+    for(size_t i = 0; i < v.size(); i++){
+      scale = max(scale, (double) fabs(v[i]));
+      difference = max(difference, (double) fabs(u[i] - v[i]));
+    }
+    if(scale > 0) largest = max(largest, difference / scale);
+  }
+  return largest;
+}
+
+// fusedFrontEnd against Windowing -> Spectrum and FFT -> CartesianToPolar on
+// the same signal: every front end key has to agree to float rounding,
+// within 1e-4 of the frame's largest value. Phases are compared where the
+// bin is within 60 dB of the frame's peak (elsewhere they are rounding
+// noise), within 1e-3 rad.
+static bool checkFrontEnd(){
+  const int sampleRate = 44100, frameSize = 2048, hopSize = 512;
+  const vector<Real> signal = mixture(sampleRate, 5);
+  const vector<string> keys = { "Windowing", "Spectrum", "Magnitudes", "Phases" };
+
+  MLTKCore fused, separate;
+  fused.fusedFrontEnd = true;
+  separate.fusedFrontEnd = false;
+  Analysis a = analyse(fused, signal, frameSize, sampleRate, hopSize, keys);
+  Analysis b = analyse(separate, signal, frameSize, sampleRate, hopSize, keys);
+
+  bool pass = true;
+  for(const char *key : { "Windowing", "Spectrum", "Magnitudes" }){
+    const double difference = largestDifference(a, b, key);
+    cout << "frontend: " << key << " differs by " << difference << " of the frame's peak at most" << endl;
+    pass = pass && difference <= 1e-4;
+  }
+
+  const vector<vector<Real> > &magnitudes = b.frames["Magnitudes"];
+  const vector<vector<Real> > &p = a.frames["Phases"], &q = b.frames["Phases"];
+  double phase = p.empty() || p.size() != q.size() || q.size() != magnitudes.size() ? INFINITY : 0;
+  for(size_t k = 0; k < p.size() && k < q.size() && k < magnitudes.size(); k++){
+    const vector<Real> &m = magnitudes[k];
+    if(p[k].size() != m.size() || q[k].size() != m.size()){
+      phase = INFINITY;
+      break;
+    }
+    const Real peak = *max_element(m.begin(), m.end());
+    for(size_t i = 0; i < m.size(); i++){
+      if(m[i] < 1e-3 * peak) continue;
+      const double difference = fabs(remainder(p[k][i] - q[k][i], 2 * M_PI));
+      phase = max(phase, difference);
+    }
+  }
+  cout << "frontend: Phases differ by " << phase << " rad at most" << endl;
+  pass = pass && phase <= 1e-3;
+  return report("frontend", pass);
+}
+
+// fusedCepstrum against the separate MFCC, BFCC and GFCC on the same
+// signal: the bands have to agree within 1e-4 of the frame's largest band,
+// the coefficients (dB scaled) within 1e-3 of the frame's largest one
+static bool checkCepstrum(){
+  const int sampleRate = 44100, frameSize = 2048, hopSize = 512;
+  const vector<Real> signal = mixture(sampleRate, 5);
+  const vector<string> keys = { "MFCC.bands", "MFCC.coefs", "BFCC.bands", "BFCC.coefs", "GFCC.bands", "GFCC.coefs" };
+
+  MLTKCore fused, separate;
+  fused.fusedCepstrum = true;
+  separate.fusedCepstrum = false;
+  Analysis a = analyse(fused, signal, frameSize, sampleRate, hopSize, keys);
+  Analysis b = analyse(separate, signal, frameSize, sampleRate, hopSize, keys);
+
+  bool pass = true;
+  for(const string &key : keys){
+    const bool bands = key.find(".bands") != string::npos;
+    const double difference = largestDifference(a, b, key);
+    cout << "cepstrum: " << key << " differs by " << difference << " of the frame's largest value at most" << endl;
+    pass = pass && difference <= (bands ? 1e-4 : 1e-3);
+  }
+  return report("cepstrum", pass);
+}
+
+// click tracks at four tempi: the tracker has to lock to the tempo and
+// place its beats on the clicks after 10 s
+static bool checkBeat(){
+  const int sampleRate = 44100;
+  bool pass = true;
+  for(double bpm : { 60.0, 90.0, 128.0, 170.0 }){
+    std::mt19937 random(1);
+    std::normal_distribution<float> noise(0, 1);
+    vector<Real> signal(30 * sampleRate, 0);
+    vector<double> clicks;
+    for(double t = 0.3; t < 30; t += 60 / bpm){
+      clicks.push_back(t);
+      const int start = (int) (t * sampleRate);
+      for(int i = 0; i < 2000 && start + i < (int) signal.size(); i++){
+        signal[start + i] += 0.5 * noise(random) * exp(-i / 300.0);
+      }
+    }
+    for(Real &x : signal) x += 0.01 * noise(random);
+
+    MLTKCore mltk;
+    mltk.beatTracking = true;
+    Analysis a = analyse(mltk, signal, 2048, sampleRate, 512, { "BeatTracker.bpm" });
+
+    const vector<Real> &tempo = a.values["BeatTracker.bpm"];
+    const Real estimate = tempo.empty() ? 0 : tempo.back();
+    int found;
+    double offset;
+    const int matched = match(a.events, "beat", clicks, 60 / bpm / 2, 10, found, offset);
+    cout << "beat " << bpm << " bpm: tracked " << estimate << " bpm, " << matched << "/" << found
+         << " beats after 10 s on a click, mean offset " << 1e3 * offset << " ms" << endl;
+    pass = pass && fabs(estimate - bpm) < 0.03 * bpm && found > 0 && matched >= 0.9 * found && offset < 0.03;
+  }
+  return report("beat", pass);
+}
+
+// tone and noise bursts of varying pitch and level at irregular intervals
+// over a noise floor: every burst should give one onset within 50 ms
+static bool checkOnset(){
+  const int sampleRate = 44100;
+  std::mt19937 random(1);
+  std::normal_distribution<float> noise(0, 1);
+  std::uniform_real_distribution<double> interval(0.15, 0.6);
+  vector<Real> signal(30 * sampleRate, 0);
+  vector<double> onsets;
+  int kind = 0;
+  for(double t = 0.5; t < 29; t += interval(random)){
+    onsets.push_back(t);
+    kind++;
+    const int start = (int) (t * sampleRate);
+    const double frequency = 200 + 100 * (kind % 7);
+    const double amplitude = 0.05 + 0.3 * ((kind * 37) % 10) / 10.0;
+    for(int i = 0; i < 20000 && start + i < (int) signal.size(); i++){
+      const double envelope = min(1.0, i / (0.002 * sampleRate)) * exp(-i / (0.08 * sampleRate));
+      if(kind % 3 == 0) signal[start + i] += amplitude * noise(random) * exp(-i / 400.0);
+      else signal[start + i] += amplitude * envelope * sin(2 * M_PI * frequency * i / sampleRate);
+    }
+  }
+  for(Real &x : signal) x += 0.003 * noise(random);
+
+  MLTKCore mltk;
+  Analysis a = analyse(mltk, signal, 2048, sampleRate, 512, {});
+
+  int found;
+  double error;
+  const int matched = match(a.events, "onset", onsets, 0.05, 0, found, error);
+  cout << "onset: " << matched << "/" << onsets.size() << " bursts found, " << found - matched
+       << " false, mean error " << 1e3 * error << " ms" << endl;
+  return report("onset", matched >= 0.9 * onsets.size() && found - matched <= 0.05 * onsets.size());
+}
+
+// C F G Am C Dm G C, 2 s per chord: the chord has to be right 1.1 s into
+// each one, and the key C major by the end
+static bool checkTonal(){
+  const int sampleRate = 44100, frameSize = 2048, hopSize = 512;
+  const int progression[8][3] = { {60,64,67}, {65,69,72}, {67,71,74}, {69,72,76}, {60,64,67}, {62,65,69}, {67,71,74}, {60,64,67} };
+  const char *names[8] = { "C", "F", "G", "Am", "C", "Dm", "G", "C" };
+  std::mt19937 random(1);
+  std::normal_distribution<float> noise(0, 1);
+  vector<Real> signal(16 * sampleRate, 0);
+  for(int c = 0; c < 8; c++){
+    for(int n = 0; n < 3; n++){
+      const double frequency = 440 * pow(2.0, (progression[c][n] - 69) / 12.0);
+      for(int i = 0; i < 2 * sampleRate; i++){
+        for(int h = 1; h <= 4; h++){
+          signal[c * 2 * sampleRate + i] += 0.1 / h * sin(2 * M_PI * frequency * h * i / sampleRate);
+        }
+      }
+    }
+  }
+  for(Real &x : signal) x += 0.005 * noise(random);
+
+  MLTKCore mltk;
+  mltk.tonal = true;
+  Analysis a = analyse(mltk, signal, frameSize, sampleRate, hopSize, { "Tonal.chord", "Tonal.key", "Tonal.scale" });
+
+  const vector<string> &chords = a.labels["Tonal.chord"];
+  int right = 0, total = 0;
+  for(int k = 0; k < (int) chords.size(); k++){
+    const double t = frameTime(k, frameSize, sampleRate, hopSize);
+    const int chord = (int) (t / 2);
+    if(chord > 7 || t - 2 * chord < 1.1) continue;
+    total++;
+    if(chords[k] == names[chord]) right++;
+  }
+  const string key = a.labels["Tonal.key"].empty() ? "" : a.labels["Tonal.key"].back();
+  const string scale = a.labels["Tonal.scale"].empty() ? "" : a.labels["Tonal.scale"].back();
+  cout << "tonal: chord right " << right << "/" << total << " frames 1.1 s into a chord, key " << key << " " << scale << endl;
+  return report("tonal", total > 0 && right >= 0.8 * total && key == "C" && scale == "major");
+}
+
+// EBU Tech 3341's calibration: a 997 Hz sine of peak 0.1 at 48 kHz is
+// -23.0 LUFS
+static bool checkLoudness(){
+  const int sampleRate = 48000, frameSize = 2048, hopSize = 512;
+  vector<Real> signal(20 * sampleRate);
+  for(size_t i = 0; i < signal.size(); i++) signal[i] = 0.1 * sin(2 * M_PI * 997 * i / sampleRate);
+
+  MLTKCore mltk;
+  mltk.loudness = true;
+  Analysis a = analyse(mltk, signal, frameSize, sampleRate, hopSize, { "Loudness.momentary", "Loudness.integrated" });
+
+  const vector<Real> &momentary = a.values["Loudness.momentary"];
+  const vector<Real> &integrated = a.values["Loudness.integrated"];
+  const int k = (int) ((19.0 * sampleRate - frameSize / 2) / hopSize);
+  const Real m = k < (int) momentary.size() ? momentary[k] : 0;
+  const Real i = integrated.empty() ? 0 : integrated.back();
+  cout << "loudness: momentary at 19 s " << m << " LUFS, integrated " << i << " LUFS (expected -23.0)" << endl;
+  return report("loudness", fabs(m + 23) < 0.1 && fabs(i + 23) < 0.1);
+}
+
+// eight harmonic tones from 87 to 1374 Hz in noise, 2 s each: the median
+// pitch of each has to be within 1%
+static bool checkYin(){
+  const int sampleRate = 44100, frameSize = 2048, hopSize = 512;
+  std::mt19937 random(3);
+  std::normal_distribution<float> noise(0, 1);
+  vector<double> pitches;
+  vector<Real> signal(16 * sampleRate, 0);
+  for(int c = 0; c < 8; c++){
+    const double f0 = 80 * pow(1.5, c) + 7;
+    pitches.push_back(f0);
+    for(int i = 0; i < 2 * sampleRate; i++){
+      Real &x = signal[c * 2 * sampleRate + i];
+      for(int h = 1; h <= 5; h++) x += 0.3 / h * sin(2 * M_PI * f0 * h * i / sampleRate);
+      x += 0.02 * noise(random);
+    }
+  }
+
+  MLTKCore mltk;
+  mltk.yinPitch = true;
+  Analysis a = analyse(mltk, signal, frameSize, sampleRate, hopSize, { "PitchYin.pitch" });
+
+  const vector<Real> &pitch = a.values["PitchYin.pitch"];
+  bool pass = true;
+  cout << "yin:";
+  for(int c = 0; c < 8; c++){
+    // the frames well inside the tone
+    vector<Real> inside;
+    for(int k = 0; k < (int) pitch.size(); k++){
+      const double t = frameTime(k, frameSize, sampleRate, hopSize);
+      if(t > 2 * c + 0.25 && t < 2 * c + 1.75) inside.push_back(pitch[k]);
+    }
+    if(inside.empty()){
+      pass = false;
+      continue;
+    }
+    nth_element(inside.begin(), inside.begin() + inside.size() / 2, inside.end());
+    const Real median = inside[inside.size() / 2];
+    cout << " " << pitches[c] << "->" << median;
+    pass = pass && fabs(median - pitches[c]) < 0.01 * pitches[c];
+  }
+  cout << " Hz" << endl;
+  return report("yin", pass);
+}
+
+// sections of 20 to 60 s, each with its own chord, timbre and noise
+// level: the boundaries should be found within 3 s
+static bool checkSegmenter(){
+  const int sampleRate = 44100;
+  std::mt19937 random(5);
+  std::normal_distribution<float> noise(0, 1);
+  std::uniform_real_distribution<double> length(20, 60), uniform(0, 1);
+  std::uniform_int_distribution<int> note(48, 72);
+  vector<Real> signal;
+  vector<double> boundaries;
+  for(int s = 0; s < 10; s++){
+    if(s > 0) boundaries.push_back((double) signal.size() / sampleRate);
+    const int samples = (int) (length(random) * sampleRate);
+    double frequencies[3];
+    for(double &f : frequencies) f = 440 * pow(2.0, (note(random) - 69) / 12.0);
+    const double tilt = 0.3 + 0.6 * uniform(random);
+    const double level = 0.002 + 0.05 * uniform(random);
+    const size_t start = signal.size();
+    signal.resize(start + samples, 0);
+    for(int i = 0; i < samples; i++){
+      Real &x = signal[start + i];
+      for(double f : frequencies){
+        double weight = 0.1;
+        for(int h = 1; h <= 4; h++, weight *= tilt) x += weight * sin(2 * M_PI * f * h * i / sampleRate);
+      }
+      x += level * noise(random);
+    }
+  }
+
+  MLTKCore mltk;
+  mltk.segmenter = true;
+  Analysis a = analyse(mltk, signal, 2048, sampleRate, 1024, {});
+
+  int found;
+  double error;
+  const int matched = match(a.events, "boundary", boundaries, 3, 0, found, error);
+  cout << "segmenter: " << matched << "/" << boundaries.size() << " boundaries found, " << found - matched
+       << " false, mean error " << error << " s" << endl;
+  return report("segmenter", matched >= 0.7 * boundaries.size() && found - matched <= 0.3 * boundaries.size());
+}
+
+// noise with clicks at 5 and 40 s, silence from 10 to 30 s, 50 Hz hum from
+// 35 s and an inter-sample peak at 45 s, through Essentia's detectors. The
+// detectors together have to stay under 5% of one core.
+static bool checkQC(){
+  const int sampleRate = 44100;
+  std::mt19937 random(1);
+  std::normal_distribution<float> noise(0, 1);
+  vector<Real> signal(60 * sampleRate, 0);
+  for(size_t i = 0; i < signal.size(); i++){
+    const double t = (double) i / sampleRate;
+    if(t < 10 || t >= 30) signal[i] = 0.01 * noise(random);
+    if(t >= 35) signal[i] += 0.03 * sin(2 * M_PI * 50 * t);
+  }
+  for(double t : { 5.0, 40.0 }) signal[(int) (t * sampleRate)] += 0.8;
+  // two full scale samples in a row peak about 2 dB higher between them
+  signal[45 * sampleRate] = signal[45 * sampleRate + 1] = 0.99;
+
+  MLTKCore mltk;
+  mltk.qualityMonitor = true;
+  Analysis a = analyse(mltk, signal, 2048, sampleRate, 512, {});
+
+  int found;
+  double error;
+  const int clicks = match(a.events, "click", { 5.0, 40.0 }, 0.01, 0, found, error);
+  const int peaks = match(a.events, "truePeak", { 45.0 }, 0.01, 0, found, error);
+  bool hum = false;
+  for(const MLTKEvent &e : a.events){
+    if(string(e.type) == "hum" && fabs(e.value - 50) < 2) hum = true;
+  }
+
+  const char *detectors[] = { "click", "discontinuity", "saturation", "gap", "noiseBurst", "truePeak", "hum" };
+  Real total = 0;
+  cout << "qc: clicks " << clicks << "/2, true peak " << peaks << "/1, hum " << (hum ? "found" : "missed") << endl;
+  cout << "qc: % of one core:";
+  for(size_t i = 0; i < a.cpu.size() && i < 7; i++){
+    cout << " " << detectors[i] << " " << 100 * a.cpu[i];
+    total += a.cpu[i];
+  }
+  cout << ", total " << 100 * total << endl;
+  return report("qc", clicks == 2 && peaks == 1 && hum && !a.cpu.empty() && total < 0.05);
+}
+
+int main(int argc, char *argv[]){
+  const string which = argc > 1 ? argv[1] : "all";
+  const struct { const char *name; bool (*check)(); } checks[] = {
+    { "frontend", checkFrontEnd },
+    { "cepstrum", checkCepstrum },
+    { "beat", checkBeat },
+    { "onset", checkOnset },
+    { "tonal", checkTonal },
+    { "loudness", checkLoudness },
+    { "yin", checkYin },
+    { "segmenter", checkSegmenter },
+    { "qc", checkQC },
+  };
+
+  bool pass = true, ran = false;
+  for(auto &c : checks){
+    if(which != "all" && which != c.name) continue;
+    ran = true;
+    pass = c.check() && pass;
+  }
+  if(!ran){
+    cerr << "usage: " << argv[0] << " [frontend|cepstrum|beat|onset|tonal|loudness|yin|segmenter|qc|all]" << endl;
+    return 1;
+  }
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+// The bundled linux64 libfftw3f.a was built against a glibc that still
+// exported the -ffast-math alias __log_finite, which glibc 2.31 dropped.
+// Weak, so a glibc or another object that still has it wins.
+
+#include <cmath>
+
+extern "C" __attribute__((weak)) double __log_finite(double x){
+  return log(x);
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+// Measures MLTKCore throughput without a window or sound card: synthetic
+// audio is pushed through audioIn() in device sized blocks and run() is
+// called after every block, the same way an ofApp drives MLTK.
+//
+//   ./bin/headlessBenchmark [seconds] [blockSize] [frameSize] [hopSize] [fused|separate|sliding] [qc]
+//
+// The fifth argument picks MLTK's fused stages (MLTKSpectrum, MLTKCepstrum),
+// the separate Essentia algorithms they replace, or the fused stages with
+// MLTKSlidingSpectrum in place of MLTKSpectrum. "qc" also runs the audio
+// problem detectors (qualityMonitor) and prints the share of one core each
+// of them took.
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "ofxMLTKCore.h"
+
+int main(int argc, char *argv[]){
+  float seconds = argc > 1 ? atof(argv[1]) : 60;
+  int blockSize = argc > 2 ? atoi(argv[2]) : 256;
+  int frameSize = argc > 3 ? atoi(argv[3]) : 2048;
+  int hopSize = argc > 4 ? atoi(argv[4]) : 512;
+  string stages = argc > 5 ? argv[5] : "fused";
+  bool fused = stages != "separate";
+  bool qc = argc > 6 && string(argv[6]) == "qc";
+  const int sampleRate = 44100;
+  const int numChannels = 2;
+
+  MLTKCore mltk;
+  mltk.fusedFrontEnd = fused;
+  mltk.fusedCepstrum = fused;
+  mltk.slidingSpectrum = stages == "sliding";
+  mltk.qualityMonitor = qc;
+  mltk.setup(frameSize, sampleRate, hopSize);
+
+  // a few harmonics over some noise, so the peak and pitch based
+  // algorithms have something to do
+  std::mt19937 random(1);
+  std::normal_distribution<float> noise(0.0, 0.01);
+  std::vector<float> block(blockSize * numChannels);
+
+  const long long numberOfBlocks = (long long) (seconds * sampleRate / blockSize);
+  long long sample = 0;
+  double busy = 0, worst = 0;
+
+  for(long long b = 0; b < numberOfBlocks; b++){
+    for(int i = 0; i < blockSize; i++, sample++){
+      double t = (double) sample / sampleRate;
+      float v = 0.3 * sin(2 * M_PI * 220 * t) + 0.2 * sin(2 * M_PI * 440 * t) + 0.1 * sin(2 * M_PI * 660 * t) + noise(random);
+      for(int c = 0; c < numChannels; c++) block[i * numChannels + c] = v;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    mltk.audioIn(&block[0], blockSize, numChannels);
+    mltk.run();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    busy += elapsed;
+    if(elapsed > worst) worst = elapsed;
+  }
+
+  double audio = (double) sample / sampleRate;
+  double deadline = (double) blockSize / sampleRate;
+
+  cout << "frameSize " << frameSize << ", hopSize " << hopSize << ", blockSize " << blockSize
+       << ", " << stages << " stages" << (qc ? ", QC detectors" : "") << endl;
+  cout << "analysed " << audio << " s of audio in " << busy << " s, "
+       << audio / busy << "x real-time" << endl;
+  cout << "frames: " << mltk.framesAnalyzed << ", "
+       << 1e6 * busy / max(1ULL, mltk.framesAnalyzed) << " us per frame" << endl;
+  cout << "block deadline " << 1e3 * deadline << " ms, mean " << 1e3 * busy / max(1LL, numberOfBlocks)
+       << " ms, worst " << 1e3 * worst << " ms" << endl;
+
+  // QC.cpu is averaged over the last 10 s, in MLTKQCMonitor's detector order
+  if(qc && mltk.pool.contains<vector<vector<Real> > >("QC.cpu")){
+    const vector<Real> &cpu = mltk.pool.value<vector<vector<Real> > >("QC.cpu").back();
+    const char *detectors[] = { "click", "discontinuity", "saturation", "gap", "noiseBurst", "truePeak", "hum" };
+    Real total = 0;
+    cout << "QC detectors, % of one core:";
+    for(size_t i = 0; i < cpu.size() && i < 7; i++){
+      cout << " " << detectors[i] << " " << 100 * cpu[i];
+      total += cpu[i];
+    }
+    cout << ", total " << 100 * total << endl;
+  }
+
+  mltk.exit();
+  return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+// Measures FFTW plans for the FFT sizes MLTK uses and stores them as wisdom,
+// meant to be run once at install time on the machine that does the
+// analysis. Point MLTKCore::fftWisdom (or MLTKFFT::loadWisdom()) at the
+// file afterwards.
+//
+//   ./bin/mltkWisdom mltk.wisdom [effort] [size...]
+//
+// effort is measure, patient (default) or exhaustive.
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "ofxMLTKFFT.h"
+
+int main(int argc, char *argv[]){
+  if(argc < 2){
+    cerr << "usage: " << argv[0] << " wisdomFile [effort] [size...]" << endl;
+    return 1;
+  }
+
+  string fileName = argv[1];
+  string effort = argc > 2 ? argv[2] : "patient";
+
+  vector<int> sizes;
+  for(int i = 3; i < argc; i++) sizes.push_back(atoi(argv[i]));
+  if(sizes.empty()) sizes = { 256, 512, 1024, 2048, 4096, 8192, 16384, 32768 };
+
+  // keep what an earlier run already measured
+  MLTKFFT::loadWisdom(fileName);
+  MLTKFFT::train(sizes, effort);
+
+  if(!MLTKFFT::saveWisdom(fileName)){
+    cerr << "could not write " << fileName << endl;
+    return 1;
+  }
+  cout << "-------- wisdom written to " << fileName << " --------" << endl;
+  return 0;
+}
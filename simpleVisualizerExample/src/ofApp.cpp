@@ -13,11 +13,14 @@ void ofApp::setup(){
   int numberOfOutputChannels = 0;
   int numberOfInputChannels = 2;
   int sampleRate = 44100;
-  int frameSize = 512;
-  int hopSize = 256;
+  int bufferSize = 256;
+  int frameSize = 2048;
+  int hopSize = 512;
   int numberOfBuffers = 4;
   
-  soundStream.setup(numberOfOutputChannels, numberOfInputChannels, sampleRate, frameSize, numberOfBuffers);
+  // the device block size and the analysis frame/hop sizes are independent,
+  // mltk.audioIn() buffers the incoming blocks until a full hop is ready
+  soundStream.setup(numberOfOutputChannels, numberOfInputChannels, sampleRate, bufferSize, numberOfBuffers);
   mltk.setup(frameSize, sampleRate, hopSize);
   mltk.run();
 }
@@ -42,8 +45,7 @@ void ofApp::draw(){
 }
 
 void ofApp::audioIn(ofSoundBuffer &inBuffer){
-  inBuffer.getChannel(mltk.leftAudioBuffer, 0);
-  inBuffer.getChannel(mltk.rightAudioBuffer, 1);
+  mltk.audioIn(inBuffer);
 }
 
 
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "MLTKBeatTracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* MLTKBeatTracker::name = "MLTKBeatTracker";
+const char* MLTKBeatTracker::category = "Rhythm";
+const char* MLTKBeatTracker::description = "This algorithm tracks tempo and beats causally from an onset novelty stream, at a fixed cost per hop. Beats are predicted and posted as events before they happen.";
+
+MLTKBeatTracker::MLTKBeatTracker() :
+  _frameRate(0), _frameOffset(0), _preferredPeriod(0), _minLag(0), _maxLag(0), _history(0),
+  _acfDecay(0), _meanDecay(0), _scoreWeight(0.9), _tightness(5), _mean(0), _frames(0), _origin(0),
+  _period(0), _lastBeat(0), _nextBeat(0), _locked(false), _corrected(true) {
+  setName(name);
+  declareInput(_noveltyInput, 1, "novelty", "the onset novelty, one value per hop");
+  declareOutput(_bpm, 1, "bpm", "the current tempo, 0 until the tracker has locked on");
+  declareOutput(_beat, 1, "beat", "1 when a beat was posted during this hop, 0 otherwise");
+  declareParameters();
+}
+
+void MLTKBeatTracker::configure(){
+  _sampleRate = parameter("sampleRate").toReal();
+  _hopSize = parameter("hopSize").toInt();
+  _frameRate = _sampleRate / _hopSize;
+  _frameOffset = parameter("frameSize").toInt() / 2.0;
+
+  const Real minTempo = parameter("minTempo").toReal();
+  const Real maxTempo = parameter("maxTempo").toReal();
+  if(minTempo >= maxTempo){
+    throw EssentiaException("MLTKBeatTracker: minTempo has to be below maxTempo");
+  }
+  _minLag = max(1, (int) floor(60 * _frameRate / maxTempo));
+  _maxLag = max(_minLag + 2, (int) ceil(60 * _frameRate / minTempo));
+  _history = 2 * _maxLag + 2;
+  _preferredPeriod = 60 * _frameRate / parameter("preferredTempo").toReal();
+
+  _acfDecay = exp(-1 / (parameter("memory").toReal() * _frameRate));
+  _meanDecay = exp(-1 / _frameRate);
+  _tightness = parameter("tightness").toReal();
+
+  _acf.resize(2 * _maxLag + 1);
+  _novelty.resize(_history);
+  _score.resize(_history);
+  _transition.resize(_history);
+  clear();
+}
+
+void MLTKBeatTracker::clear(){
+  MLTKStatefulAlgorithm::clear();
+  fill(_acf.begin(), _acf.end(), 0);
+  fill(_novelty.begin(), _novelty.end(), 0);
+  fill(_score.begin(), _score.end(), 0);
+  _mean = 0;
+  _frames = 0;
+  _locked = false;
+  _corrected = true;
+  setPeriod(_preferredPeriod);
+}
+
+void MLTKBeatTracker::skipFrames(int count){
+  if(_frames == 0){
+    clear();
+    return;
+  }
+  MLTKStatefulAlgorithm::clear();
+
+  // the novelty was 0 through the gap: the history empties and the
+  // averages decay, but the tempo and the beat grid carry on
+  for(int i = 0; i < min(count, _history); i++){
+    _novelty[(_frames + i) % _history] = 0;
+    _score[(_frames + i) % _history] = 0;
+  }
+  _frames += count;
+  const double acfDecay = pow(_acfDecay, count);
+  for(double &a : _acf) a *= acfDecay;
+  _mean *= pow(_meanDecay, count);
+
+  // the beats that fell into the gap are not posted
+  if(_locked){
+    while(_nextBeat < _frames){
+      _lastBeat = _nextBeat;
+      _nextBeat += _period;
+    }
+    _corrected = true;
+  }
+}
+
+void MLTKBeatTracker::setPeriod(Real period){
+  _period = period;
+
+  // log gaussian around one period back, the recursion's transition weight
+  fill(_transition.begin(), _transition.end(), 0);
+  const int lo = max(1, (int) round(period / 2));
+  const int hi = min(_history - 1, (int) round(2 * period));
+  for(int v = lo; v <= hi; v++){
+    const Real d = _tightness * log(v / period);
+    _transition[v] = exp(-0.5 * d * d);
+  }
+}
+
+Real MLTKBeatTracker::tempoScore(int lag) const {
+  const Real octaves = log2(lag / _preferredPeriod);
+  return exp(-0.5 * octaves * octaves) * (_acf[lag] + 0.5 * _acf[2 * lag]);
+}
+
+void MLTKBeatTracker::updatePeriod(unsigned long long t){
+  int best = _minLag;
+  for(int lag = _minLag + 1; lag <= _maxLag; lag++){
+    if(tempoScore(lag) > tempoScore(best)) best = lag;
+  }
+  const Real peak = tempoScore(best);
+  if(peak <= 0) return;
+
+  // parabolic interpolation between the neighbouring lags
+  Real candidate = best;
+  if(best > _minLag && best < _maxLag){
+    const Real a = tempoScore(best - 1), c = tempoScore(best + 1);
+    const Real d = a - 2 * peak + c;
+    if(d < 0) candidate += 0.5 * (a - c) / d;
+  }
+
+  // follow small drifts, jump only to a clearly stronger tempo
+  const int current = min(_maxLag, max(_minLag, (int) round(_period)));
+  if(fabs(candidate - _period) <= 0.1 * _period){
+    if(fabs(candidate - _period) > 0.01) setPeriod(_period + 0.1 * (candidate - _period));
+  } else if(peak > 1.3 * tempoScore(current)){
+    setPeriod(candidate);
+  }
+
+  // start from the strongest beat score of the last period
+  if(!_locked && t >= (unsigned long long) (2 * _maxLag)){
+    unsigned long long strongest = t;
+    for(unsigned long long u = t - (int) _period + 1; u < t; u++){
+      if(scoreAt(u) > scoreAt(strongest)) strongest = u;
+    }
+    _lastBeat = strongest;
+    _nextBeat = strongest + _period;
+    _locked = true;
+    _corrected = true;
+  }
+}
+
+AlgorithmStatus MLTKBeatTracker::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  nextFrame();
+  const unsigned long long t = _frames++;
+  if(t == 0) _origin = _frameStart;
+
+  // only what rises above the local average counts
+  const Real n = _noveltyInput.firstToken();
+  _mean = _meanDecay * _mean + (1 - _meanDecay) * n;
+  const Real x = max((Real) 0, (Real) (n - _mean));
+  _novelty[t % _history] = x;
+
+  for(int lag = _minLag; lag <= 2 * _maxLag && (unsigned long long) lag <= t; lag++){
+    _acf[lag] = _acfDecay * _acf[lag] + x * noveltyAt(t - lag);
+  }
+
+  // beat score: this hop's novelty plus the best score about one period back
+  Real previous = 0;
+  for(int v = 1; v < _history && (unsigned long long) v <= t; v++){
+    if(_transition[v] > 0) previous = max(previous, _transition[v] * scoreAt(t - v));
+  }
+  _score[t % _history] = (1 - _scoreWeight) * x + _scoreWeight * previous;
+
+  updatePeriod(t);
+
+  Real beat = 0;
+  if(_locked){
+    // once the novelty around the last beat is in, move the next beat half
+    // way towards where the beat score peaked
+    if(!_corrected && t >= _lastBeat + _period / 4){
+      const long long from = max(0LL, (long long) ceil(_lastBeat - _period / 4));
+      const long long to = min((long long) t, (long long) floor(_lastBeat + _period / 4));
+      long long strongest = from;
+      for(long long u = from + 1; u <= to; u++){
+        if(scoreAt(u) > scoreAt(strongest)) strongest = u;
+      }
+      _nextBeat = _lastBeat + 0.5 * (strongest - _lastBeat) + _period;
+      _corrected = true;
+    }
+
+    // post the beat while it's still ahead: before the next hop of audio
+    // is analysed
+    const double newest = _origin + (double) t * _hopSize + 2 * _frameOffset;
+    if(sampleOf(_nextBeat) < newest + _hopSize){
+      emit("beat", (unsigned long long) max(0.0, round(sampleOf(_nextBeat))), 60 * _frameRate / _period);
+      _lastBeat = _nextBeat;
+      _nextBeat = _lastBeat + _period;
+      _corrected = false;
+      beat = 1;
+    }
+  }
+
+  _bpm.firstToken() = _locked ? 60 * _frameRate / _period : 0;
+  _beat.firstToken() = beat;
+  releaseData();
+  return OK;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef MLTKBeatTracker_h
+#define MLTKBeatTracker_h
+
+#pragma once
+
+#include <vector>
+
+#include "MLTKStatefulAlgorithm.h"
+
+// Causal beat and tempo tracker over an onset novelty stream (MLTKNovelty),
+// one value per hop, at a fixed cost per hop.
+//
+// Tempo: a leaky autocorrelation of the novelty is updated for every lag in
+// the tempo range (and its double, as harmonic support), weighted by a log
+// gaussian around preferredTempo, and the best lag is refined by parabolic
+// interpolation. The period follows small changes smoothly and only jumps
+// to a different tempo when that one is clearly stronger.
+//
+// Phase: a cumulative beat score (Ellis' dynamic programming recursion,
+// computed online) rewards novelty that arrives one period after earlier
+// strong beats. Beats are scheduled one period ahead and posted as "beat"
+// events (value: tempo) before they happen, as soon as they fall within the
+// next hop of audio, so they reach the app with no delay; each scheduled
+// beat is then nudged towards the peak of the beat score around it.
+class MLTKBeatTracker : public MLTKStatefulAlgorithm {
+ protected:
+  Sink<Real> _noveltyInput;
+  Source<Real> _bpm;
+  Source<Real> _beat;
+
+  Real _frameRate, _frameOffset, _preferredPeriod;
+  int _minLag, _maxLag, _history;
+  Real _acfDecay, _meanDecay, _scoreWeight, _tightness;
+
+  // per lag autocorrelation, and novelty / beat score histories (rings)
+  vector<double> _acf;
+  vector<Real> _novelty, _score;
+  vector<Real> _transition;
+  double _mean;
+
+  // hops since clear(), and the stream position of the first one
+  unsigned long long _frames, _origin;
+
+  Real _period;
+  double _lastBeat, _nextBeat;
+  bool _locked, _corrected;
+
+  Real noveltyAt(unsigned long long t) const { return _novelty[t % _history]; }
+  Real scoreAt(unsigned long long t) const { return _score[t % _history]; }
+  double sampleOf(double frame) const { return _origin + frame * _hopSize + _frameOffset; }
+  Real tempoScore(int lag) const;
+  void updatePeriod(unsigned long long t);
+  void setPeriod(Real period);
+
+ public:
+  MLTKBeatTracker();
+
+  void declareParameters() {
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
+    declareParameter("frameSize", "the frame size the novelty was computed on, its center is taken as the novelty's time", "[1,inf)", 2048);
+    declareParameter("hopSize", "the number of samples between consecutive novelty values", "[1,inf)", 1024);
+    declareParameter("minTempo", "the slowest tempo tracked [bpm]", "[10,inf)", 60.);
+    declareParameter("maxTempo", "the fastest tempo tracked [bpm]", "[10,inf)", 200.);
+    declareParameter("preferredTempo", "the center of the tempo prior [bpm]", "[10,inf)", 120.);
+    declareParameter("memory", "the time constant of the tempo autocorrelation [s]", "(0,inf)", 4.);
+    declareParameter("tightness", "how strictly beats have to follow the period in the beat score", "(0,inf)", 5.);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+  void clear();
+  void skipFrames(int count);
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKBeatTracker_h */
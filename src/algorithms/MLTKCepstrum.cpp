@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "MLTKCepstrum.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "essentiamath.h"
+
+const char* MLTKCepstrum::name = "MLTKCepstrum";
+const char* MLTKCepstrum::category = "Spectral";
+const char* MLTKCepstrum::description = "This algorithm computes MFCC, BFCC and GFCC of a spectrum in one pass. All filterbanks are applied as one sparse matrix and share a single DCT, the outputs are the same as those of the separate algorithms.";
+
+// gammatone weights below this fraction of a band's peak are left out of
+// the sparse matrix
+static const Real minimumWeight = 1e-7;
+
+MLTKCepstrum::MLTKCepstrum() : _inputSize(0) {
+  setName(name);
+  declareInput(_spectrum, 1, "spectrum", "the audio spectrum");
+  declareOutput(_mfcc, 1, "mfcc", "the mel frequency cepstrum coefficients");
+  declareOutput(_mfccBands, 1, "mfccBands", "the energies in mel bands");
+  declareOutput(_bfcc, 1, "bfcc", "the bark frequency cepstrum coefficients");
+  declareOutput(_bfccBands, 1, "bfccBands", "the energies in bark bands");
+  declareOutput(_gfcc, 1, "gfcc", "the gammatone feature cepstrum coefficients");
+  declareOutput(_gfccBands, 1, "gfccBands", "the energies in ERB bands");
+  declareParameters();
+}
+
+void MLTKCepstrum::configure(){
+  _sampleRate = parameter("sampleRate").toReal();
+  _numberBands = parameter("numberBands").toInt();
+  _numberCoefficients = parameter("numberCoefficients").toInt();
+  _type = parameter("type").toString();
+  _logType = parameter("logType").toString();
+  _silenceThreshold = parameter("silenceThreshold").toReal();
+  _dbSilenceThreshold = 10 * log10(_silenceThreshold);
+  _logSilenceThreshold = log(_silenceThreshold);
+
+  if(_numberCoefficients > _numberBands){
+    throw EssentiaException("MLTKCepstrum: numberCoefficients can't be larger than numberBands");
+  }
+
+  _banks = {
+    { "MFCC", parameter("computeMFCC").toBool(),
+      parameter("mfccLowFrequencyBound").toReal(), parameter("mfccHighFrequencyBound").toReal(),
+      &_mfcc, &_mfccBands },
+    { "BFCC", parameter("computeBFCC").toBool(),
+      parameter("bfccLowFrequencyBound").toReal(), parameter("bfccHighFrequencyBound").toReal(),
+      &_bfcc, &_bfccBands },
+    { "GFCC", parameter("computeGFCC").toBool(),
+      parameter("gfccLowFrequencyBound").toReal(), parameter("gfccHighFrequencyBound").toReal(),
+      &_gfcc, &_gfccBands },
+  };
+  _enabled.clear();
+  for(int b = 0; b < (int) _banks.size(); b++){
+    if(_banks[b].enabled) _enabled.push_back(b);
+  }
+
+  // DCT-II like Essentia's DCT, with the liftering folded into its rows
+  MLTKTables::Handle dct = MLTKTables::dct(_numberBands, _numberCoefficients);
+  _dct.assign(dct->begin(), dct->end());
+  const Real lifter = parameter("liftering").toReal();
+  if(lifter != 0){
+    for(int i = 1; i < _numberCoefficients; i++){
+      const Real scale = 1.0 + (lifter / 2) * sin((M_PI * i) / lifter);
+      for(int j = 0; j < _numberBands; j++) _dct[i * _numberBands + j] *= scale;
+    }
+  }
+
+  _inputSize = 0;
+  setInputSize(parameter("inputSize").toInt());
+}
+
+void MLTKCepstrum::setInputSize(int size){
+  if(size == _inputSize) return;
+  _inputSize = size;
+
+  _weights.clear();
+  _rowStart.assign(1, 0);
+  _column.clear();
+  _weight.clear();
+
+  for(int b : _enabled){
+    const Bank &bank = _banks[b];
+    MLTKTables::Handle weights = MLTKTables::filterbank(bank.algorithm, size, _sampleRate, _numberBands,
+                                                        bank.lowFrequencyBound, bank.highFrequencyBound, _type);
+    _weights.push_back(weights);
+
+    for(int i = 0; i < _numberBands; i++){
+      const Real *row = &(*weights)[i * size];
+      const Real peak = *max_element(row, row + size);
+      for(int j = 0; j < size; j++){
+        if(row[j] > 0 && row[j] >= minimumWeight * peak){
+          _column.push_back(j);
+          _weight.push_back(row[j]);
+        }
+      }
+      _rowStart.push_back(_column.size());
+    }
+  }
+
+  _power.resize(size);
+  _bands.resize(_enabled.size() * _numberBands);
+  _logBands.resize(_enabled.size() * _numberBands);
+  _cepstrum.resize(_enabled.size() * _numberCoefficients);
+}
+
+Real MLTKCepstrum::compress(Real band) const {
+  if(_logType == "dbamp") return 2 * lin2db(band, _silenceThreshold, _dbSilenceThreshold);
+  if(_logType == "dbpow") return lin2db(band, _silenceThreshold, _dbSilenceThreshold);
+  if(_logType == "log") return band < _silenceThreshold ? _logSilenceThreshold : log(band);
+  return band;
+}
+
+AlgorithmStatus MLTKCepstrum::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  const vector<Real> &spectrum = _spectrum.firstToken();
+  if(spectrum.size() <= 1){
+    throw EssentiaException("MLTKCepstrum: the input spectrum needs at least 2 bins");
+  }
+  if((int) spectrum.size() != _inputSize) setInputSize(spectrum.size());
+
+  const Real *x = &spectrum[0];
+  if(_type == "power"){
+    for(int j = 0; j < _inputSize; j++) _power[j] = x[j] * x[j];
+    x = &_power[0];
+  }
+
+  // every band of every filterbank in one sweep over the sparse rows
+  const int rows = _bands.size();
+  const int *column = _column.empty() ? 0 : &_column[0];
+  const Real *weight = _weight.empty() ? 0 : &_weight[0];
+  for(int r = 0; r < rows; r++){
+    Real energy = 0;
+    for(int k = _rowStart[r]; k < _rowStart[r + 1]; k++){
+      energy += weight[k] * x[column[k]];
+    }
+    _bands[r] = energy;
+  }
+
+  // interleave the compressed bands so that one pass over the DCT table
+  // transforms all filterbanks at once
+  const int banks = _enabled.size();
+  for(int e = 0; e < banks; e++){
+    for(int i = 0; i < _numberBands; i++){
+      _logBands[i * banks + e] = compress(_bands[e * _numberBands + i]);
+    }
+  }
+
+  fill(_cepstrum.begin(), _cepstrum.end(), 0);
+  for(int c = 0; c < _numberCoefficients; c++){
+    const Real *d = &_dct[c * _numberBands];
+    Real *out = &_cepstrum[c * banks];
+    for(int i = 0; i < _numberBands; i++){
+      const Real *in = &_logBands[i * banks];
+      for(int e = 0; e < banks; e++) out[e] += d[i] * in[e];
+    }
+  }
+
+  for(Bank &bank : _banks){
+    bank.coefficients->firstToken().clear();
+    bank.bands->firstToken().clear();
+  }
+  for(int e = 0; e < banks; e++){
+    Bank &bank = _banks[_enabled[e]];
+    vector<Real> &coefficients = bank.coefficients->firstToken();
+    coefficients.resize(_numberCoefficients);
+    for(int c = 0; c < _numberCoefficients; c++) coefficients[c] = _cepstrum[c * banks + e];
+    bank.bands->firstToken().assign(_bands.begin() + e * _numberBands, _bands.begin() + (e + 1) * _numberBands);
+  }
+
+  releaseData();
+  return OK;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef MLTKCepstrum_h
+#define MLTKCepstrum_h
+
+#pragma once
+
+#include <vector>
+
+#include "streaming/streamingalgorithm.h"
+
+#include "ofxMLTKTables.h"
+
+using namespace std;
+using namespace essentia;
+using namespace streaming;
+
+// MFCC, BFCC and GFCC from one spectrum in a single pass.
+//
+// The mel, bark and gammatone filterbanks of all the enabled coefficients
+// are stacked into one sparse matrix (CSR, only the non zero weights of
+// each band), so every band energy comes out of one sweep over the
+// spectrum. The log bands of all filterbanks are then interleaved and go
+// through the DCT together, one multiply per table entry for all of them.
+//
+// The weights are Essentia's own (see MLTKTables::filterbank) and shared by
+// every instance, so "mfcc"/"mfccBands", "bfcc"/"bfccBands" and
+// "gfcc"/"gfccBands" match MFCC, BFCC and GFCC with the same parameters
+// within float rounding. Gammatone weights below 1e-7 of a band's peak are
+// dropped, they are never exactly zero.
+class MLTKCepstrum : public Algorithm {
+ protected:
+  Sink<vector<Real> > _spectrum;
+  Source<vector<Real> > _mfcc, _mfccBands;
+  Source<vector<Real> > _bfcc, _bfccBands;
+  Source<vector<Real> > _gfcc, _gfccBands;
+
+  struct Bank {
+    string algorithm;
+    bool enabled;
+    Real lowFrequencyBound, highFrequencyBound;
+    Source<vector<Real> > *coefficients, *bands;
+  };
+  vector<Bank> _banks;
+  vector<int> _enabled;
+
+  int _inputSize, _numberBands, _numberCoefficients;
+  Real _sampleRate, _silenceThreshold, _dbSilenceThreshold, _logSilenceThreshold;
+  string _type, _logType;
+
+  // every enabled filterbank's bands as rows of one CSR matrix
+  vector<MLTKTables::Handle> _weights;
+  vector<int> _rowStart, _column;
+  vector<Real> _weight;
+
+  // DCT rows with the liftering applied
+  vector<Real> _dct;
+
+  vector<Real> _power, _bands, _logBands, _cepstrum;
+
+  void setInputSize(int size);
+  Real compress(Real band) const;
+
+ public:
+  MLTKCepstrum();
+
+  void declareParameters() {
+    declareParameter("inputSize", "the expected spectrum size, other sizes are adapted to on the fly", "(1,inf)", 1025);
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
+    declareParameter("numberBands", "the number of bands of every filterbank", "[1,inf)", 40);
+    declareParameter("numberCoefficients", "the number of output cepstrum coefficients", "[1,inf)", 13);
+    declareParameter("type", "use magnitude or power spectrum", "{magnitude,power}", "power");
+    declareParameter("logType", "the log compression applied to the bands before the DCT", "{natural,dbpow,dbamp,log}", "dbamp");
+    declareParameter("silenceThreshold", "bands below this value are clipped to it before the log compression", "(0,inf)", 1e-10);
+    declareParameter("liftering", "the liftering coefficient, 0 disables it", "[0,inf)", 0);
+    declareParameter("computeMFCC", "whether to compute mfcc and mfccBands, they are left empty otherwise", "{true,false}", true);
+    declareParameter("computeBFCC", "whether to compute bfcc and bfccBands, they are left empty otherwise", "{true,false}", true);
+    declareParameter("computeGFCC", "whether to compute gfcc and gfccBands, they are left empty otherwise", "{true,false}", true);
+    declareParameter("mfccLowFrequencyBound", "the lower bound of the mel filterbank [Hz]", "[0,inf)", 0.);
+    declareParameter("mfccHighFrequencyBound", "the upper bound of the mel filterbank [Hz]", "(0,inf)", 11000.);
+    declareParameter("bfccLowFrequencyBound", "the lower bound of the bark filterbank [Hz]", "[0,inf)", 0.);
+    declareParameter("bfccHighFrequencyBound", "the upper bound of the bark filterbank [Hz]", "(0,inf)", 11000.);
+    declareParameter("gfccLowFrequencyBound", "the lower bound of the gammatone filterbank [Hz]", "[0,inf)", 40.);
+    declareParameter("gfccHighFrequencyBound", "the upper bound of the gammatone filterbank [Hz]", "(0,inf)", 22050.);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKCepstrum_h */
@@ -0,0 +1,549 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "MLTKChunkedLoader.h"
+
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+}
+
+const char* MLTKChunkedLoader::name = "MLTKChunkedLoader";
+const char* MLTKChunkedLoader::category = "Input/output";
+const char* MLTKChunkedLoader::description = "This algorithm loads the raw audio data from an audio file, downmixes it to mono and resamples it to the given sampling rate. The file is decoded in fixed-size chunks on a separate thread so memory usage does not depend on the length of the file.";
+
+// number of samples handed to the network per process() call
+static const int outputSize = 4096;
+
+// input samples the converter runs before a range that doesn't start at
+// the beginning of the file, many times the length of its filter
+static const long long resamplerWarmUp = 4096;
+
+static long long greatestCommonDivisor(long long a, long long b){
+  while(b != 0){
+    long long t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// the channel count moved into AVChannelLayout in ffmpeg 5.1
+static int channelCount(const AVCodecContext *codec){
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(59, 24, 100)
+  return codec->ch_layout.nb_channels;
+#else
+  return codec->channels;
+#endif
+}
+
+static string errorString(int error){
+  char message[AV_ERROR_MAX_STRING_SIZE] = { 0 };
+  av_strerror(error, message, sizeof(message));
+  return message;
+}
+
+// one sample of a packed format, scaled to [-1, 1)
+static float sampleValue(const uint8_t *data, AVSampleFormat format, int index){
+  switch(format){
+    case AV_SAMPLE_FMT_U8: return (data[index] - 128) / 128.0f;
+    case AV_SAMPLE_FMT_S16: return ((const int16_t*) data)[index] / 32768.0f;
+    case AV_SAMPLE_FMT_S32: return ((const int32_t*) data)[index] / 2147483648.0f;
+    case AV_SAMPLE_FMT_FLT: return ((const float*) data)[index];
+    case AV_SAMPLE_FMT_DBL: return (float) ((const double*) data)[index];
+    default: return 0;
+  }
+}
+
+MLTKChunkedLoader::MLTKChunkedLoader() :
+  _file(0), _format(0), _codec(0), _packet(0), _frame(0), _stream(-1), _flushing(false),
+  _decodedPosition(0), _inputSkip(0), _inputRate(0), _channels(0), _inputLength(-1),
+  _resampler(0), _ratio(1.0), _chunkSize(0),
+  _startSample(0), _endSample(-1), _skip(0),
+  _current(0), _position(0),
+  _readerStarted(false), _readerDone(false), _stopReader(false) {
+  setName(name);
+  declareOutput(_audio, outputSize, "audio", "the input audio signal");
+  declareParameters();
+}
+
+MLTKChunkedLoader::~MLTKChunkedLoader(){
+  closeFile();
+}
+
+bool MLTKChunkedLoader::canOpen(const string &filename){
+  SF_INFO info;
+  info.format = 0;
+  SNDFILE *file = sf_open(filename.c_str(), SFM_READ, &info);
+  if(!file) return false;
+  sf_close(file);
+  return true;
+}
+
+bool MLTKChunkedLoader::canStream(const string &filename){
+  if(canOpen(filename)) return true;
+
+  AVFormatContext *format = 0;
+  if(avformat_open_input(&format, filename.c_str(), 0, 0) != 0) return false;
+  bool decodable = false;
+  if(avformat_find_stream_info(format, 0) >= 0){
+    const int stream = av_find_best_stream(format, AVMEDIA_TYPE_AUDIO, -1, -1, 0, 0);
+    decodable = stream >= 0 && avcodec_find_decoder(format->streams[stream]->codecpar->codec_id) != 0;
+  }
+  avformat_close_input(&format);
+  return decodable;
+}
+
+void MLTKChunkedLoader::setRange(long long startSample, long long endSample){
+  _startSample = std::max(0LL, startSample);
+  _endSample = endSample;
+  reset();
+}
+
+long long MLTKChunkedLoader::numberOfSamples() const {
+  if(_inputLength < 0) return 0;
+  return (long long) (_inputLength * _ratio);
+}
+
+void MLTKChunkedLoader::configure(){
+  closeFile();
+
+  if(parameter("filename").toString().empty()) return;
+
+  openFile();
+
+  _chunkSize = parameter("chunkSize").toInt();
+
+  // everything that is prefetched lives in these buffers, at least two so
+  // the I/O thread can fill one while the network reads the other
+  long long maxBytes = (long long) (parameter("maxMemory").toReal() * 1024 * 1024);
+  int numberOfChunks = std::max(2, (int) (maxBytes / ((long long) _chunkSize * sizeof(Real))));
+
+  _buffers.assign(numberOfChunks, vector<Real>());
+  for(int i = 0; i < numberOfChunks; i++){
+    _buffers[i].reserve(_chunkSize);
+  }
+
+  reset();
+}
+
+void MLTKChunkedLoader::openFile(){
+  const string filename = parameter("filename").toString();
+
+  _info.format = 0;
+  _file = sf_open(filename.c_str(), SFM_READ, &_info);
+  if(_file){
+    _inputRate = _info.samplerate;
+    _channels = _info.channels;
+    _inputLength = _info.frames;
+  } else {
+    const string error = sf_strerror(0);
+    if(!openDecoder(filename)){
+      throw EssentiaException("MLTKChunkedLoader: could not open ", filename, ": ", error);
+    }
+  }
+
+  _ratio = parameter("sampleRate").toReal() / _inputRate;
+  if(_ratio != 1.0){
+    int error = 0;
+    _resampler = src_new(SRC_SINC_FASTEST, 1, &error);
+    if(!_resampler){
+      throw EssentiaException("MLTKChunkedLoader: ", src_strerror(error));
+    }
+  }
+}
+
+bool MLTKChunkedLoader::openDecoder(const string &filename){
+  if(avformat_open_input(&_format, filename.c_str(), 0, 0) != 0) return false;
+  if(avformat_find_stream_info(_format, 0) < 0) return false;
+
+  _stream = av_find_best_stream(_format, AVMEDIA_TYPE_AUDIO, -1, -1, 0, 0);
+  if(_stream < 0) return false;
+  AVStream *stream = _format->streams[_stream];
+  const AVCodec *decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+  if(!decoder) return false;
+
+  _codec = avcodec_alloc_context3(decoder);
+  if(!_codec || avcodec_parameters_to_context(_codec, stream->codecpar) < 0) return false;
+  if(avcodec_open2(_codec, decoder, 0) < 0) return false;
+
+  _packet = av_packet_alloc();
+  _frame = av_frame_alloc();
+  if(!_packet || !_frame) return false;
+
+  _inputRate = _codec->sample_rate;
+  _channels = channelCount(_codec);
+  if(_inputRate <= 0 || _channels <= 0) return false;
+
+  if(stream->duration != AV_NOPTS_VALUE){
+    _inputLength = av_rescale_q(stream->duration, stream->time_base, av_make_q(1, _inputRate));
+  } else if(_format->duration != AV_NOPTS_VALUE){
+    _inputLength = av_rescale_q(_format->duration, av_make_q(1, AV_TIME_BASE), av_make_q(1, _inputRate));
+  }
+  return true;
+}
+
+void MLTKChunkedLoader::closeFile(){
+  stopReader();
+
+  if(_resampler){
+    src_delete(_resampler);
+    _resampler = 0;
+  }
+  if(_file){
+    sf_close(_file);
+    _file = 0;
+  }
+  av_frame_free(&_frame);
+  av_packet_free(&_packet);
+  avcodec_free_context(&_codec);
+  avformat_close_input(&_format);
+  _stream = -1;
+  _inputRate = 0;
+  _channels = 0;
+  _inputLength = -1;
+  _ready.clear();
+  _free.clear();
+  _current = 0;
+}
+
+void MLTKChunkedLoader::reset(){
+  Algorithm::reset();
+  stopReader();
+
+  // With a converter, a range can't start on the input sample under
+  // startSample, that is a fraction of a sample off and the converter would
+  // start cold. Instead it starts on the last input sample before the range
+  // (and a warm-up) that falls on the output grid too, and the output
+  // before startSample is dropped, so the samples are those of a run from
+  // the start of the file.
+  long long inputStart = _startSample;
+  _skip = 0;
+  if(_resampler){
+    const long long in = _inputRate;
+    const long long out = (long long) llround(parameter("sampleRate").toReal());
+    const long long g = greatestCommonDivisor(in, out);
+    const long long earliest = std::max(0LL, (long long) (_startSample / _ratio) - resamplerWarmUp);
+    inputStart = earliest / (in / g) * (in / g);
+    _skip = _startSample - inputStart / (in / g) * (out / g);
+  }
+
+  if(_file) sf_seek(_file, (sf_count_t) inputStart, SEEK_SET);
+  if(_codec){
+    // back to the start, the range is reached by dropping the samples
+    // before it
+    av_seek_frame(_format, _stream, 0, AVSEEK_FLAG_BACKWARD);
+    avcodec_flush_buffers(_codec);
+    _flushing = false;
+    _decoded.clear();
+    _decodedPosition = 0;
+    _inputSkip = inputStart;
+  }
+  if(_resampler) src_reset(_resampler);
+
+  _ready.clear();
+  _free.clear();
+  for(size_t i = 0; i < _buffers.size(); i++){
+    _free.push_back(&_buffers[i]);
+  }
+  _current = 0;
+  _position = 0;
+  _readerError.clear();
+}
+
+void MLTKChunkedLoader::startReader(){
+  _stopReader = false;
+  _readerDone = false;
+  _readerStarted = true;
+  _reader = std::thread(&MLTKChunkedLoader::readerLoop, this);
+}
+
+void MLTKChunkedLoader::stopReader(){
+  if(!_readerStarted) return;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopReader = true;
+  }
+  _freeCondition.notify_all();
+  _reader.join();
+  _readerStarted = false;
+}
+
+// Reads up to count input samples mixed to mono, fewer only at the end of
+// the file. Returns -1 with error set when decoding fails.
+int MLTKChunkedLoader::readInput(float *mono, vector<float> &interleaved, int count, string &error){
+  if(_file){
+    sf_count_t n = sf_readf_float(_file, &interleaved[0], count);
+    if(n < 0) n = 0;
+
+    for(int i = 0; i < n; i++){
+      float sample = 0.0;
+      for(int c = 0; c < _channels; c++){
+        sample += interleaved[i * _channels + c];
+      }
+      mono[i] = sample / _channels;
+    }
+    return (int) n;
+  }
+
+  int n = 0;
+  while(n < count){
+    if(_decodedPosition == (int) _decoded.size()){
+      _decoded.clear();
+      _decodedPosition = 0;
+      if(!decodeFrame(error)) return error.empty() ? n : -1;
+      continue;
+    }
+
+    int available = (int) _decoded.size() - _decodedPosition;
+    if(_inputSkip > 0){
+      const int dropped = (int) std::min((long long) available, _inputSkip);
+      _decodedPosition += dropped;
+      _inputSkip -= dropped;
+      continue;
+    }
+
+    available = std::min(available, count - n);
+    std::copy(_decoded.begin() + _decodedPosition, _decoded.begin() + _decodedPosition + available, mono + n);
+    _decodedPosition += available;
+    n += available;
+  }
+  return n;
+}
+
+// Decodes the next frame of the audio stream into _decoded. Returns false
+// at the end of the stream, or with error set when decoding fails.
+bool MLTKChunkedLoader::decodeFrame(string &error){
+  while(true){
+    int status = avcodec_receive_frame(_codec, _frame);
+    if(status == 0){
+      appendFrame();
+      av_frame_unref(_frame);
+      return true;
+    }
+    if(status == AVERROR_EOF) return false;
+    if(status != AVERROR(EAGAIN) || _flushing){
+      error = errorString(status);
+      return false;
+    }
+
+    // the decoder needs the next packet of the stream, or the flush
+    // packet once the file is read
+    status = av_read_frame(_format, _packet);
+    if(status < 0){
+      _flushing = true;
+      avcodec_send_packet(_codec, 0);
+      continue;
+    }
+    if(_packet->stream_index == _stream){
+      status = avcodec_send_packet(_codec, _packet);
+      // a corrupt packet only costs its own samples
+      if(status < 0 && status != AVERROR_INVALIDDATA){
+        av_packet_unref(_packet);
+        error = errorString(status);
+        return false;
+      }
+    }
+    av_packet_unref(_packet);
+  }
+}
+
+void MLTKChunkedLoader::appendFrame(){
+  const AVSampleFormat format = (AVSampleFormat) _frame->format;
+  const bool planar = av_sample_fmt_is_planar(format) != 0;
+  const AVSampleFormat packed = av_get_packed_sample_fmt(format);
+  const int count = _frame->nb_samples;
+
+  _decoded.assign(count, 0.0f);
+  for(int c = 0; c < _channels; c++){
+    const uint8_t *data = _frame->extended_data[planar ? c : 0];
+    for(int i = 0; i < count; i++){
+      _decoded[i] += sampleValue(data, packed, planar ? i : i * _channels + c);
+    }
+  }
+  for(float &sample : _decoded) sample /= _channels;
+  _decodedPosition = 0;
+}
+
+void MLTKChunkedLoader::readerLoop(){
+  // input frames per read, sized so a read fits in one output chunk
+  const int readSize = std::max(1, (int) (_chunkSize / _ratio));
+  vector<float> interleaved(_file ? readSize * _channels : 0);
+  vector<float> mono(readSize);
+
+  // decoded input that did not fit in the previous chunk yet
+  int pending = 0, offset = 0;
+  bool endOfFile = false;
+
+  // output samples left in the requested range, and converter output to
+  // drop before it starts
+  long long remaining = _endSample < 0 ? -1 : std::max(0LL, _endSample - _startSample);
+  long long skip = _skip;
+
+  while(true){
+    vector<Real> *chunk;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _freeCondition.wait(lock, [this]{ return _stopReader || !_free.empty(); });
+      if(_stopReader) return;
+      chunk = _free.front();
+      _free.pop_front();
+    }
+
+    // within the reserved capacity, this never allocates
+    chunk->resize(_chunkSize);
+    int filled = 0;
+    bool finished = false;
+
+    while(filled < _chunkSize){
+      if(offset == pending && !endOfFile){
+        string error;
+        int n = readInput(&mono[0], interleaved, readSize, error);
+        if(n < 0){
+          // process() throws it on the analysis thread
+          std::lock_guard<std::mutex> lock(_mutex);
+          _readerError = error;
+          finished = true;
+          break;
+        }
+        if(n < readSize) endOfFile = true;
+        pending = n;
+        offset = 0;
+      }
+
+      if(_resampler){
+        SRC_DATA data;
+        data.data_in = &mono[0] + offset;
+        data.input_frames = pending - offset;
+        data.data_out = &(*chunk)[filled];
+        data.output_frames = _chunkSize - filled;
+        data.end_of_input = endOfFile ? 1 : 0;
+        data.src_ratio = _ratio;
+
+        int error = src_process(_resampler, &data);
+        if(error != 0){
+          // process() throws it on the analysis thread
+          std::lock_guard<std::mutex> lock(_mutex);
+          _readerError = src_strerror(error);
+          finished = true;
+          break;
+        }
+
+        offset += data.input_frames_used;
+        filled += data.output_frames_gen;
+
+        // everything before it was dropped too, so the chunk starts at 0
+        if(skip > 0){
+          int n = (int) std::min(skip, (long long) filled);
+          std::copy(chunk->begin() + n, chunk->begin() + filled, chunk->begin());
+          filled -= n;
+          skip -= n;
+        }
+
+        // fully flushed once the converter stops producing at the end
+        if(endOfFile && offset == pending && data.output_frames_gen == 0){
+          finished = true;
+          break;
+        }
+      } else {
+        int n = std::min(pending - offset, _chunkSize - filled);
+        std::copy(mono.begin() + offset, mono.begin() + offset + n, chunk->begin() + filled);
+        offset += n;
+        filled += n;
+
+        if(endOfFile && offset == pending){
+          finished = true;
+          break;
+        }
+      }
+    }
+
+    if(remaining >= 0){
+      if(filled >= remaining){
+        filled = (int) remaining;
+        finished = true;
+      }
+      remaining -= filled;
+    }
+
+    chunk->resize(filled);
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if(filled > 0){
+        _ready.push_back(chunk);
+      } else {
+        _free.push_back(chunk);
+      }
+      if(finished) _readerDone = true;
+    }
+    _readyCondition.notify_one();
+
+    if(finished) return;
+  }
+}
+
+AlgorithmStatus MLTKChunkedLoader::process(){
+  if(!_file && !_codec){
+    throw EssentiaException("MLTKChunkedLoader: no file has been opened, set the filename parameter first");
+  }
+  if(!_readerStarted) startReader();
+
+  if(!_current || _position >= (int) _current->size()){
+    std::unique_lock<std::mutex> lock(_mutex);
+    if(_current){
+      _free.push_back(_current);
+      _current = 0;
+      _freeCondition.notify_one();
+    }
+
+    _readyCondition.wait(lock, [this]{ return !_ready.empty() || _readerDone; });
+    if(!_readerError.empty()){
+      throw EssentiaException("MLTKChunkedLoader: ", parameter("filename").toString(), ": ", _readerError);
+    }
+    if(_ready.empty()){
+      shouldStop(true);
+      return PASS;
+    }
+    _current = _ready.front();
+    _ready.pop_front();
+    _position = 0;
+  }
+
+  int n = std::min(outputSize, (int) _current->size() - _position);
+  _audio.setAcquireSize(n);
+  _audio.setReleaseSize(n);
+
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  fastcopy(&_audio.tokens()[0], &(*_current)[_position], n);
+  _position += n;
+
+  releaseData();
+
+  return OK;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef MLTKChunkedLoader_h
+#define MLTKChunkedLoader_h
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "sndfile.h"
+#include "samplerate.h"
+
+#include "streaming/streamingalgorithm.h"
+
+// ffmpeg's types, its headers stay in the .cpp
+struct AVFormatContext;
+struct AVCodecContext;
+struct AVPacket;
+struct AVFrame;
+
+using namespace std;
+using namespace essentia;
+using namespace streaming;
+
+// Mono file source that decodes in fixed-size chunks instead of loading
+// the whole file like MonoLoader/AudioLoader do.
+//
+// Decoding (libsndfile), down-mixing and sample rate conversion
+// (libsamplerate) run on a separate I/O thread that prefetches chunks into
+// a bounded queue, so decoding overlaps with the analysis and peak memory
+// depends on chunkSize/maxMemory only, never on the length of the file.
+//
+// It is a drop-in replacement for MonoLoader: same "audio" output, same
+// filename/sampleRate parameters. libsndfile reads WAV, AIFF, FLAC and Ogg
+// and can seek (canOpen()). Everything else ffmpeg can decode, such as
+// MP3, AAC and M4A, is decoded packet by packet with ffmpeg (canStream()).
+// ffmpeg sources can't seek exactly, a range is reached by decoding and
+// dropping everything before it.
+class MLTKChunkedLoader : public Algorithm {
+ protected:
+  Source<Real> _audio;
+
+  SNDFILE *_file;
+  SF_INFO _info;
+
+  AVFormatContext *_format;
+  AVCodecContext *_codec;
+  AVPacket *_packet;
+  AVFrame *_frame;
+  int _stream;
+  bool _flushing;
+
+  // decoded input, mixed to mono, that hasn't been read yet, and the
+  // input samples still to drop before the range starts
+  vector<float> _decoded;
+  int _decodedPosition;
+  long long _inputSkip;
+
+  // the input whichever decoder has open, the length is -1 if unknown
+  int _inputRate, _channels;
+  long long _inputLength;
+
+  SRC_STATE *_resampler;
+  double _ratio;
+  int _chunkSize;
+
+  // range to decode, in samples at the output sampling rate
+  long long _startSample, _endSample;
+
+  // converter output dropped at the start, see reset()
+  long long _skip;
+
+  // Chunks are allocated once at configure time and recycled, the I/O
+  // thread waits for a free one when the analysis falls behind
+  vector<vector<Real> > _buffers;
+  deque<vector<Real>*> _ready, _free;
+  vector<Real> *_current;
+  int _position;
+
+  std::thread _reader;
+  std::mutex _mutex;
+  std::condition_variable _readyCondition, _freeCondition;
+  bool _readerStarted, _readerDone, _stopReader;
+
+  // set by the I/O thread when resampling fails, it stops reading
+  string _readerError;
+
+  void openFile();
+  bool openDecoder(const string &filename);
+  void closeFile();
+  int readInput(float *mono, vector<float> &interleaved, int count, string &error);
+  bool decodeFrame(string &error);
+  void appendFrame();
+  void startReader();
+  void stopReader();
+  void readerLoop();
+
+ public:
+  MLTKChunkedLoader();
+  ~MLTKChunkedLoader();
+
+  void declareParameters() {
+    declareParameter("filename", "the name of the file from which to read", "", "");
+    declareParameter("sampleRate", "the desired output sampling rate [Hz]", "(0,inf)", 44100.);
+    declareParameter("chunkSize", "the number of samples decoded at once", "[1024,inf)", 65536);
+    declareParameter("maxMemory", "the memory ceiling for the prefetched chunks [MB]", "(0,inf)", 16.);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+  void reset();
+
+  // Restricts decoding to [startSample, endSample) at the output sampling
+  // rate, endSample < 0 reads to the end of the file. This is a setter
+  // rather than a parameter because essentia's integer parameters are
+  // stored as floats and can't address samples past a few minutes.
+  void setRange(long long startSample, long long endSample);
+
+  // Length of the file in samples at the output sampling rate, estimated
+  // from the container's duration for ffmpeg sources (0 if it has none)
+  long long numberOfSamples() const;
+
+  // Whether libsndfile can decode the file, which makes ranges cheap
+  static bool canOpen(const string &filename);
+
+  // Whether libsndfile or ffmpeg can decode the file
+  static bool canStream(const string &filename);
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKChunkedLoader_h */
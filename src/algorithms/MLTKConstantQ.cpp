@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "MLTKConstantQ.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* MLTKConstantQ::name = "MLTKConstantQ";
+const char* MLTKConstantQ::category = "Tonal";
+const char* MLTKConstantQ::description = "This algorithm computes a constant-Q spectrum octave by octave on a recursively decimated signal, with one short FFT and one shared kernel for all octaves. It also outputs a chromagram and an HPCP style pitch class profile.";
+
+// taps of the windowed sinc low pass in front of every decimation
+static const int lowPassTaps = 31;
+
+MLTKConstantQ::MLTKConstantQ() : _octaves(0), _binsPerOctave(0), _fftSize(0), _referenceBin(0), _in(0), _out(0) {
+  setName(name);
+  declareInput(_frame, 1, "frame", "the input audio frame, consecutive frames are one hop apart");
+  declareOutput(_spectrumCQ, 1, "spectrumCQ", "the constant-Q magnitude spectrum, lowest bin first");
+  declareOutput(_chromagram, 1, "chromagram", "the magnitudes folded into one octave, starting at the pitch class of minFrequency");
+  declareOutput(_hpcp, 1, "hpcp", "the energies folded into one octave, starting at the pitch class of referenceFrequency");
+  declareParameters();
+}
+
+MLTKConstantQ::~MLTKConstantQ(){
+  MLTKFFT::free(_in);
+  MLTKFFT::free(_out);
+}
+
+void MLTKConstantQ::configure(){
+  const Real sampleRate = parameter("sampleRate").toReal();
+  const Real minFrequency = parameter("minFrequency").toReal();
+  const Real threshold = parameter("threshold").toReal();
+  _hopSize = parameter("hopSize").toInt();
+  _octaves = parameter("numberOfOctaves").toInt();
+  _binsPerOctave = parameter("binsPerOctave").toInt();
+
+  // every octave is analysed like the top one, so the top one has to stay
+  // clear of the decimation filter's transition band
+  const Real topOctave = minFrequency * pow(2.0, _octaves - 1);
+  if(2 * topOctave > 0.3 * sampleRate){
+    throw EssentiaException("MLTKConstantQ: the top octave has to end below 0.3 times the sample rate, lower minFrequency or numberOfOctaves");
+  }
+
+  // long enough for the kernel of the lowest bin of an octave
+  const double Q = 1.0 / (pow(2.0, 1.0 / _binsPerOctave) - 1.0);
+  const int longest = ceil(Q * sampleRate / topOctave);
+  _fftSize = 2;
+  while(_fftSize < longest) _fftSize *= 2;
+
+  _kernel = MLTKTables::constantQKernel(sampleRate, topOctave, _binsPerOctave, _fftSize);
+  const int bins = _fftSize / 2 + 1;
+  _rowStart.assign(1, 0);
+  _column.clear();
+  _weight.clear();
+  for(int k = 0; k < _binsPerOctave; k++){
+    const Real *row = &(*_kernel)[k * bins * 2];
+    Real peak = 0;
+    for(int j = 0; j < bins; j++) peak = max(peak, (Real) hypot(row[2 * j], row[2 * j + 1]));
+    for(int j = 0; j < bins; j++){
+      if(hypot(row[2 * j], row[2 * j + 1]) > threshold * peak){
+        _column.push_back(j);
+        _weight.push_back(row[2 * j]);
+        _weight.push_back(row[2 * j + 1]);
+      }
+    }
+    _rowStart.push_back(_column.size());
+  }
+
+  // half band windowed sinc (blackman), unity gain at DC
+  _lowPass.resize(lowPassTaps);
+  const int center = lowPassTaps / 2;
+  Real sum = 0;
+  for(int n = 0; n < lowPassTaps; n++){
+    const double t = n - center;
+    const double sinc = t == 0 ? 1.0 : sin(M_PI * t / 2) / (M_PI * t / 2);
+    const double blackman = 0.42 - 0.5 * cos(2 * M_PI * n / (lowPassTaps - 1)) + 0.08 * cos(4 * M_PI * n / (lowPassTaps - 1));
+    _lowPass[n] = sinc * blackman;
+    sum += _lowPass[n];
+  }
+  for(Real &h : _lowPass) h /= sum;
+
+  // pitch class of the reference frequency, relative to the first bin
+  _referenceBin = (int) round(_binsPerOctave * log2(parameter("referenceFrequency").toReal() / minFrequency));
+  _referenceBin = ((_referenceBin % _binsPerOctave) + _binsPerOctave) % _binsPerOctave;
+
+  _plan = MLTKFFT::plan(_fftSize, MLTKFFT::REAL_FORWARD);
+  MLTKFFT::free(_in);
+  MLTKFFT::free(_out);
+  _in = MLTKFFT::allocReal(_fftSize);
+  _out = MLTKFFT::allocComplex(bins);
+
+  _buffers.assign(_octaves, vector<Real>(_fftSize));
+  _history.assign(_octaves, vector<Real>(lowPassTaps));
+  _historyPosition.assign(_octaves, 0);
+  _odd.assign(_octaves, false);
+  _fresh.assign(_octaves, 0);
+  _decimated.assign(_octaves, vector<Real>());
+  _magnitudes.assign(_octaves * _binsPerOctave, 0);
+  clear();
+}
+
+void MLTKConstantQ::clear(){
+  MLTKStatefulAlgorithm::clear();
+  for(int o = 0; o < _octaves; o++){
+    fill(_buffers[o].begin(), _buffers[o].end(), 0);
+    fill(_history[o].begin(), _history[o].end(), 0);
+    _historyPosition[o] = 0;
+    _odd[o] = false;
+    _fresh[o] = 0;
+  }
+  fill(_magnitudes.begin(), _magnitudes.end(), 0);
+}
+
+void MLTKConstantQ::push(int octave, const Real *x, int count){
+  if(count == 0) return;
+
+  // keep the newest fftSize samples
+  vector<Real> &buffer = _buffers[octave];
+  if(count >= _fftSize){
+    copy(x + count - _fftSize, x + count, buffer.begin());
+  } else {
+    copy(buffer.begin() + count, buffer.end(), buffer.begin());
+    copy(x, x + count, buffer.end() - count);
+  }
+  _fresh[octave] += count;
+
+  if(octave + 1 == _octaves) return;
+
+  // low pass and keep every other sample for the octave below
+  vector<Real> &history = _history[octave];
+  vector<Real> &decimated = _decimated[octave];
+  int &position = _historyPosition[octave];
+  decimated.clear();
+  for(int i = 0; i < count; i++){
+    history[position] = x[i];
+    position = (position + 1) % lowPassTaps;
+    _odd[octave] = !_odd[octave];
+    if(_odd[octave]) continue;
+
+    // the filter is symmetric, so the order of the history doesn't matter
+    Real y = 0;
+    for(int t = 0; t < lowPassTaps; t++){
+      y += _lowPass[t] * history[(position + t) % lowPassTaps];
+    }
+    decimated.push_back(y);
+  }
+  push(octave + 1, decimated.empty() ? 0 : &decimated[0], decimated.size());
+}
+
+void MLTKConstantQ::transform(int octave){
+  copy(_buffers[octave].begin(), _buffers[octave].end(), _in);
+  _plan->execute(_in, _out);
+
+  const float *X = (const float*) _out;
+  Real *magnitudes = &_magnitudes[octave * _binsPerOctave];
+  for(int k = 0; k < _binsPerOctave; k++){
+    Real re = 0, im = 0;
+    for(int i = _rowStart[k]; i < _rowStart[k + 1]; i++){
+      const Real xr = X[2 * _column[i]], xi = X[2 * _column[i] + 1];
+      const Real kr = _weight[2 * i], ki = _weight[2 * i + 1];
+      re += xr * kr - xi * ki;
+      im += xr * ki + xi * kr;
+    }
+    magnitudes[k] = sqrt(re * re + im * im);
+  }
+}
+
+AlgorithmStatus MLTKConstantQ::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  int count;
+  const Real *x = newSamples(_frame.firstToken(), count);
+  push(0, x, count);
+
+  for(int o = 0; o < _octaves; o++){
+    if(_fresh[o] == 0) continue;
+    transform(o);
+    _fresh[o] = 0;
+  }
+
+  // octave 0 is the top one, the output starts at the bottom
+  vector<Real> &spectrumCQ = _spectrumCQ.firstToken();
+  spectrumCQ.resize(_octaves * _binsPerOctave);
+  for(int o = 0; o < _octaves; o++){
+    copy(_magnitudes.begin() + o * _binsPerOctave, _magnitudes.begin() + (o + 1) * _binsPerOctave,
+         spectrumCQ.begin() + (_octaves - 1 - o) * _binsPerOctave);
+  }
+
+  vector<Real> &chromagram = _chromagram.firstToken();
+  vector<Real> &hpcp = _hpcp.firstToken();
+  chromagram.assign(_binsPerOctave, 0);
+  hpcp.assign(_binsPerOctave, 0);
+  for(int i = 0; i < (int) spectrumCQ.size(); i++){
+    const int k = i % _binsPerOctave;
+    chromagram[k] += spectrumCQ[i];
+    hpcp[(k - _referenceBin + _binsPerOctave) % _binsPerOctave] += spectrumCQ[i] * spectrumCQ[i];
+  }
+  const Real chromaMax = *max_element(chromagram.begin(), chromagram.end());
+  const Real hpcpMax = *max_element(hpcp.begin(), hpcp.end());
+  if(chromaMax > 0) for(Real &c : chromagram) c /= chromaMax;
+  if(hpcpMax > 0) for(Real &h : hpcp) h /= hpcpMax;
+
+  releaseData();
+  return OK;
+}
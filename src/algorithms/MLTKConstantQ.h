@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef MLTKConstantQ_h
+#define MLTKConstantQ_h
+
+#pragma once
+
+#include <vector>
+
+#include "MLTKStatefulAlgorithm.h"
+#include "ofxMLTKFFT.h"
+#include "ofxMLTKTables.h"
+
+// Multi-resolution constant-Q transform, octave by octave.
+//
+// The top octave is analysed at the full sample rate, every octave below it
+// on a copy of the signal low passed and decimated by 2 once more. With the
+// sample rate halving along with the frequencies, every octave needs the
+// same short FFT and the same spectral kernel (MLTKTables::constantQKernel,
+// kept sparse), instead of one FFT long enough for the lowest bin. The
+// kernels are right aligned, so each bin only waits for its own Q periods:
+// a few ms in the top octave, the length of the lowest bin's kernel at the
+// bottom. Octaves that got no new decimated samples in a hop keep their
+// previous values.
+//
+// Besides the spectrum it folds the octaves into a chromagram (magnitudes,
+// starting at the pitch class of minFrequency) and an HPCP style profile
+// (energies, starting at referenceFrequency), both normalized to a maximum
+// of 1.
+class MLTKConstantQ : public MLTKStatefulAlgorithm {
+ protected:
+  Sink<vector<Real> > _frame;
+  Source<vector<Real> > _spectrumCQ;
+  Source<vector<Real> > _chromagram;
+  Source<vector<Real> > _hpcp;
+
+  int _octaves, _binsPerOctave, _fftSize, _referenceBin;
+
+  // the shared kernel as CSR, one row per bin of an octave
+  MLTKTables::Handle _kernel;
+  vector<int> _rowStart, _column;
+  vector<Real> _weight;   // interleaved re/im
+
+  // anti aliasing low pass applied before each decimation by 2
+  vector<Real> _lowPass;
+
+  // per octave: the newest fftSize samples at its own rate, the low pass
+  // history feeding the next octave, and its newest magnitudes
+  vector<vector<Real> > _buffers;
+  vector<vector<Real> > _history;
+  vector<int> _historyPosition;
+  vector<bool> _odd;
+  vector<int> _fresh;
+  vector<vector<Real> > _decimated;
+  vector<Real> _magnitudes;
+
+  MLTKFFT::Handle _plan;
+  float *_in;
+  fftwf_complex *_out;
+
+  void push(int octave, const Real *x, int count);
+  void transform(int octave);
+
+ public:
+  MLTKConstantQ();
+  ~MLTKConstantQ();
+
+  void declareParameters() {
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
+    declareParameter("hopSize", "the number of samples between consecutive input frames", "[1,inf)", 1024);
+    declareParameter("minFrequency", "the frequency of the lowest bin [Hz]", "(0,inf)", 32.7032);
+    declareParameter("numberOfOctaves", "the number of octaves analysed", "[1,inf)", 7);
+    declareParameter("binsPerOctave", "the number of bins per octave", "[1,inf)", 12);
+    declareParameter("threshold", "kernel weights below this fraction of a bin's peak are ignored", "[0,1)", 0.01);
+    declareParameter("referenceFrequency", "the frequency whose pitch class is the first bin of the hpcp [Hz]", "(0,inf)", 440.);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+  void clear();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKConstantQ_h */
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "MLTKHarmonicRemix.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* MLTKHarmonicRemix::name = "MLTKHarmonicRemix";
+const char* MLTKHarmonicRemix::category = "Synthesis";
+const char* MLTKHarmonicRemix::description = "This algorithm rebalances the sinusoids and the rest of a complex spectrum, for harmonic/noise remixing before resynthesis.";
+
+MLTKHarmonicRemix::MLTKHarmonicRemix() :
+  _sampleRate(44100), _lobeWidth(2), _harmonicGain(1), _noiseGain(1) {
+  setName(name);
+  declareInput(_fftInput, 1, "fft", "the complex spectrum of the windowed frame");
+  declareInput(_frequencies, 1, "frequencies", "the frequencies of the sinusoids in the frame, 0 for none [Hz]");
+  declareOutput(_fftOutput, 1, "fft", "the remixed complex spectrum");
+  declareParameters();
+}
+
+void MLTKHarmonicRemix::configure(){
+  _sampleRate = parameter("sampleRate").toReal();
+  _lobeWidth = parameter("lobeWidth").toInt();
+  setGains(parameter("harmonicGain").toReal(), parameter("noiseGain").toReal());
+}
+
+void MLTKHarmonicRemix::setGains(Real harmonic, Real noise){
+  _harmonicGain = harmonic;
+  _noiseGain = noise;
+}
+
+AlgorithmStatus MLTKHarmonicRemix::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  const vector<complex<Real> > &input = _fftInput.firstToken();
+  const vector<Real> &frequencies = _frequencies.firstToken();
+  const int bins = input.size();
+  const int size = 2 * (bins - 1);
+
+  const Real harmonic = _harmonicGain, noise = _noiseGain;
+  _mask.assign(bins, noise);
+  if(harmonic != noise && size > 0){
+    for(Real f : frequencies){
+      if(f <= 0) continue;
+      const int center = (int) round(f * size / _sampleRate);
+      for(int k = max(0, center - _lobeWidth); k <= min(bins - 1, center + _lobeWidth); k++){
+        _mask[k] = harmonic;
+      }
+    }
+  }
+
+  vector<complex<Real> > &output = _fftOutput.firstToken();
+  output.resize(bins);
+  for(int k = 0; k < bins; k++) output[k] = input[k] * _mask[k];
+
+  releaseData();
+  return OK;
+}
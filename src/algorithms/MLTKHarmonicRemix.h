@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef MLTKHarmonicRemix_h
+#define MLTKHarmonicRemix_h
+
+#pragma once
+
+#include <atomic>
+#include <complex>
+#include <vector>
+
+#include "streaming/streamingalgorithm.h"
+
+using namespace std;
+using namespace essentia;
+using namespace streaming;
+
+// Harmonic/noise remix of a complex spectrum, for live resynthesis. The
+// bins within lobeWidth of a sinusoid (e.g. the frequencies SineModelAnal
+// tracks) are scaled by the harmonic gain, all others by the noise gain,
+// and the phases are left alone. With both gains at 1 the spectrum comes
+// out untouched, so IFFT -> MLTKOverlapAdd gives the input back exactly.
+//
+// The gains can be changed from another thread while the network runs,
+// with setGains().
+class MLTKHarmonicRemix : public Algorithm {
+ protected:
+  Sink<vector<complex<Real> > > _fftInput;
+  Sink<vector<Real> > _frequencies;
+  Source<vector<complex<Real> > > _fftOutput;
+
+  Real _sampleRate;
+  int _lobeWidth;
+  atomic<Real> _harmonicGain, _noiseGain;
+
+  vector<Real> _mask;
+
+ public:
+  MLTKHarmonicRemix();
+
+  void declareParameters() {
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
+    declareParameter("lobeWidth", "the number of bins on either side of a sinusoid that belong to it", "[0,inf)", 2);
+    declareParameter("harmonicGain", "the gain of the sinusoids", "[0,inf)", 1.);
+    declareParameter("noiseGain", "the gain of everything else", "[0,inf)", 1.);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+
+  void setGains(Real harmonic, Real noise);
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKHarmonicRemix_h */
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "MLTKLPC.h"
+
+#include <algorithm>
+
+const char* MLTKLPC::name = "MLTKLPC";
+const char* MLTKLPC::category = "Spectral";
+const char* MLTKLPC::description = "This algorithm computes the LPC coefficients of a long sliding window once per hop, keeping the autocorrelation up to date incrementally and running Levinson-Durbin on it. The outputs are those of LPC (type regular) on the window.";
+
+MLTKLPC::MLTKLPC() : _order(0), _windowSize(0), _position(0), _sinceSync(0) {
+  setName(name);
+  declareInput(_frame, 1, "frame", "the input audio frame, consecutive frames are one hop apart");
+  declareOutput(_lpc, 1, "lpc", "the LPC coefficients");
+  declareOutput(_reflection, 1, "reflection", "the reflection coefficients");
+  declareParameters();
+}
+
+void MLTKLPC::configure(){
+  _order = parameter("order").toInt();
+  _windowSize = parameter("windowSize").toInt();
+  _hopSize = parameter("hopSize").toInt();
+
+  if(_windowSize <= _order){
+    throw EssentiaException("MLTKLPC: windowSize has to be larger than the order");
+  }
+
+  _window.resize(_windowSize);
+  _r.resize(_order + 1);
+  clear();
+}
+
+void MLTKLPC::clear(){
+  MLTKStatefulAlgorithm::clear();
+  fill(_window.begin(), _window.end(), 0);
+  fill(_r.begin(), _r.end(), 0);
+  _position = 0;
+  _sinceSync = 0;
+}
+
+void MLTKLPC::add(Real x){
+  // the oldest sample leaves, taking its products with the samples after it
+  const double oldest = _window[_position];
+  for(int l = 0; l <= _order; l++){
+    _r[l] -= oldest * _window[(_position + l) % _windowSize];
+  }
+
+  // the new one takes its place, with its products with the samples before it
+  _window[_position] = x;
+  for(int l = 0; l <= _order; l++){
+    _r[l] += x * _window[(_position - l + _windowSize) % _windowSize];
+  }
+  _position = (_position + 1) % _windowSize;
+}
+
+void MLTKLPC::synchronize(){
+  fill(_r.begin(), _r.end(), 0);
+  for(int n = 0; n < _windowSize; n++){
+    const double x = _window[(_position + n) % _windowSize];
+    for(int l = 0; l <= _order && n + l < _windowSize; l++){
+      _r[l] += x * _window[(_position + n + l) % _windowSize];
+    }
+  }
+  _sinceSync = 0;
+}
+
+AlgorithmStatus MLTKLPC::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  int count;
+  const Real *x = newSamples(_frame.firstToken(), count);
+  for(int i = 0; i < count; i++) add(x[i]);
+  _sinceSync += count;
+  if(_sinceSync >= _windowSize) synchronize();
+
+  vector<Real> &lpc = _lpc.firstToken();
+  vector<Real> &reflection = _reflection.firstToken();
+  lpc.assign(_order + 1, 0);
+  reflection.assign(_order, 0);
+  lpc[0] = 1;
+
+  // Levinson-Durbin, with LPC's sign conventions. A silent window leaves
+  // the predictor at 1, 0, ...
+  vector<double> a(_order + 1, 0), previous(_order + 1, 0);
+  a[0] = 1;
+  double error = _r[0];
+  for(int i = 1; i <= _order && error > 0; i++){
+    double k = _r[i];
+    for(int j = 1; j < i; j++) k += _r[i - j] * a[j];
+    k /= error;
+
+    previous = a;
+    for(int j = 1; j < i; j++) a[j] = previous[j] - k * previous[i - j];
+    a[i] = -k;
+    reflection[i - 1] = k;
+    error *= 1 - k * k;
+  }
+  for(int i = 1; i <= _order; i++) lpc[i] = a[i];
+
+  releaseData();
+  return OK;
+}
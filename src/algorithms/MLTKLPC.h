@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef MLTKLPC_h
+#define MLTKLPC_h
+
+#pragma once
+
+#include <vector>
+
+#include "MLTKStatefulAlgorithm.h"
+
+// Linear prediction over a long sliding window at a short hop.
+//
+// Like LPC (type regular) on a windowSize frame, but the autocorrelation
+// lags up to the order are kept up to date sample by sample: every sample
+// entering the window adds its products with the order samples before it,
+// every sample leaving subtracts its products with the ones after it. Only
+// Levinson-Durbin runs per hop, so the cost no longer depends on the window
+// length. The lags are kept in double and recomputed from the window once
+// per windowSize samples, so rounding can't build up.
+//
+// Until windowSize samples have come in, the missing part of the window
+// counts as silence.
+class MLTKLPC : public MLTKStatefulAlgorithm {
+ protected:
+  Sink<vector<Real> > _frame;
+  Source<vector<Real> > _lpc;
+  Source<vector<Real> > _reflection;
+
+  int _order, _windowSize;
+  vector<double> _window, _r;
+  int _position, _sinceSync;
+
+  void add(Real x);
+  void synchronize();
+
+ public:
+  MLTKLPC();
+
+  void declareParameters() {
+    declareParameter("order", "the order of the LPC analysis (typically [8,14])", "[2,inf)", 10);
+    declareParameter("windowSize", "the number of samples the autocorrelation covers", "[2,inf)", 32768);
+    declareParameter("hopSize", "the number of samples between consecutive input frames", "[1,inf)", 1024);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+  void clear();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKLPC_h */
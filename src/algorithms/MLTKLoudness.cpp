@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#include "MLTKLoudness.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* MLTKLoudness::name = "MLTKLoudness";
+const char* MLTKLoudness::category = "Loudness/dynamics";
+const char* MLTKLoudness::description = "This algorithm meters the momentary, short-term and integrated loudness of EBU R128 on a stream of frames, in constant time per sample and constant memory. The integrated loudness is gated on a histogram of the gating blocks.";
+
+// the 4 and 30 sub-blocks of 100 ms of the momentary and short-term windows
+static const int momentaryBlocks = 4;
+static const int shortTermBlocks = 30;
+
+// the histogram of gating block loudness
+static const Real histogramMin = -70;
+static const Real histogramStep = 0.1;
+static const int histogramBins = 800;
+
+static Real loudness(double meanSquare){
+  if(meanSquare <= 0) return histogramMin;
+  return max(histogramMin, (Real) (-0.691 + 10 * log10(meanSquare)));
+}
+
+MLTKLoudness::MLTKLoudness() :
+  _blockSize(4410), _blockFill(0), _blockEnergy(0), _blockCount(0), _next(0),
+  _momentarySum(0), _shortTermSum(0),
+  _momentaryLoudness(histogramMin), _shortTermLoudness(histogramMin), _integratedLoudness(histogramMin) {
+  setName(name);
+  declareInput(_frame, 1, "frame", "the audio frame, of which only the newest hop is new");
+  declareOutput(_momentary, 1, "momentary", "the loudness of the last 400 ms [LUFS]");
+  declareOutput(_shortTerm, 1, "shortTerm", "the loudness of the last 3 s [LUFS]");
+  declareOutput(_integrated, 1, "integrated", "the gated loudness since the start or the last clear() [LUFS]");
+  declareParameters();
+}
+
+void MLTKLoudness::configure(){
+  _sampleRate = parameter("sampleRate").toReal();
+  _hopSize = parameter("hopSize").toInt();
+  _blockSize = max(1, (int) round(_sampleRate / 10));
+
+  // BS.1770's stage 1 high shelf and stage 2 high pass, from their analog
+  // prototypes so they fit any sample rate
+  {
+    const double f0 = 1681.974450955533, G = 3.999843853973347, Q = 0.7071752369554196;
+    const double K = tan(M_PI * f0 / _sampleRate);
+    const double Vh = pow(10.0, G / 20);
+    const double Vb = pow(Vh, 0.4996667741545416);
+    const double a0 = 1 + K / Q + K * K;
+    _shelf[0] = (Vh + Vb * K / Q + K * K) / a0;
+    _shelf[1] = 2 * (K * K - Vh) / a0;
+    _shelf[2] = (Vh - Vb * K / Q + K * K) / a0;
+    _shelf[3] = 2 * (K * K - 1) / a0;
+    _shelf[4] = (1 - K / Q + K * K) / a0;
+  }
+  {
+    const double f0 = 38.13547087602444, Q = 0.5003270373238773;
+    const double K = tan(M_PI * f0 / _sampleRate);
+    const double a0 = 1 + K / Q + K * K;
+    _highPass[0] = 1;
+    _highPass[1] = -2;
+    _highPass[2] = 1;
+    _highPass[3] = 2 * (K * K - 1) / a0;
+    _highPass[4] = (1 - K / Q + K * K) / a0;
+  }
+
+  _blocks.resize(shortTermBlocks);
+  _histogram.resize(histogramBins);
+  _histogramEnergy.resize(histogramBins);
+  clear();
+}
+
+void MLTKLoudness::clear(){
+  MLTKStatefulAlgorithm::clear();
+  for(int i = 0; i < 4; i++) _state[i] = 0;
+  _blockFill = 0;
+  _blockEnergy = 0;
+  fill(_blocks.begin(), _blocks.end(), 0);
+  _blockCount = 0;
+  _next = 0;
+  _momentarySum = 0;
+  _shortTermSum = 0;
+  fill(_histogram.begin(), _histogram.end(), 0);
+  fill(_histogramEnergy.begin(), _histogramEnergy.end(), 0);
+  _momentaryLoudness = histogramMin;
+  _shortTermLoudness = histogramMin;
+  _integratedLoudness = histogramMin;
+}
+
+void MLTKLoudness::skipFrames(int count){
+  MLTKStatefulAlgorithm::clear();
+  for(int i = 0; i < 4; i++) _state[i] = 0;
+  _blockFill = 0;
+  _blockEnergy = 0;
+
+  // silent blocks replace the windows' contents, they never pass the
+  // absolute gate so the integrated loudness stays where it was
+  const long long blocks = (long long) count * _hopSize / _blockSize;
+  for(long long b = 0; b < min(blocks, (long long) shortTermBlocks); b++) addBlock(0);
+}
+
+void MLTKLoudness::addBlock(double meanSquare){
+  // the blocks leaving the windows: 4 and 30 back
+  const int size = _blocks.size();
+  const double leavingMomentary = _blockCount >= momentaryBlocks ? _blocks[(_next - momentaryBlocks + size) % size] : 0;
+  const double leavingShortTerm = _blockCount >= shortTermBlocks ? _blocks[_next] : 0;
+  _momentarySum += meanSquare - leavingMomentary;
+  _shortTermSum += meanSquare - leavingShortTerm;
+  _blocks[_next] = meanSquare;
+  _next = (_next + 1) % size;
+  _blockCount++;
+
+  // rebuilt once per lap, so rounding errors don't pile up
+  if(_next == 0){
+    _momentarySum = 0;
+    _shortTermSum = 0;
+    for(int i = 0; i < size; i++){
+      _shortTermSum += _blocks[i];
+      if(i >= size - momentaryBlocks) _momentarySum += _blocks[i];
+    }
+  }
+
+  const int momentaryCount = min(_blockCount, momentaryBlocks);
+  const int shortTermCount = min(_blockCount, shortTermBlocks);
+  _momentaryLoudness = loudness(_momentarySum / momentaryCount);
+  _shortTermLoudness = loudness(_shortTermSum / shortTermCount);
+
+  // each complete 400 ms window is a gating block, those below the
+  // absolute gate don't count at all
+  if(_blockCount >= momentaryBlocks){
+    const Real l = -0.691 + 10 * log10(max(_momentarySum / momentaryBlocks, 1e-20));
+    if(l > histogramMin){
+      const int bin = min(histogramBins - 1, (int) ((l - histogramMin) / histogramStep));
+      _histogram[bin]++;
+      _histogramEnergy[bin] += _momentarySum / momentaryBlocks;
+      _integratedLoudness = integrate();
+    }
+  }
+}
+
+Real MLTKLoudness::integrate() const {
+  // the mean energy of the blocks above the absolute gate
+  double energy = 0;
+  unsigned long long count = 0;
+  for(int b = 0; b < histogramBins; b++){
+    energy += _histogramEnergy[b];
+    count += _histogram[b];
+  }
+  if(count == 0) return histogramMin;
+
+  // and again above the relative gate, 10 LU below that
+  const Real gate = -0.691 + 10 * log10(energy / count) - 10;
+  const int first = max(0, (int) ((gate - histogramMin) / histogramStep));
+  energy = 0;
+  count = 0;
+  for(int b = first; b < histogramBins; b++){
+    energy += _histogramEnergy[b];
+    count += _histogram[b];
+  }
+  if(count == 0) return histogramMin;
+  return loudness(energy / count);
+}
+
+AlgorithmStatus MLTKLoudness::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  int count;
+  const Real *x = newSamples(_frame.firstToken(), count);
+
+  const double *s = _shelf, *h = _highPass;
+  double *z = _state;
+  for(int i = 0; i < count; i++){
+    // transposed direct form II, shelf then high pass
+    const double u = s[0] * x[i] + z[0];
+    z[0] = s[1] * x[i] - s[3] * u + z[1];
+    z[1] = s[2] * x[i] - s[4] * u;
+    const double y = h[0] * u + z[2];
+    z[2] = h[1] * u - h[3] * y + z[3];
+    z[3] = h[2] * u - h[4] * y;
+
+    _blockEnergy += y * y;
+    if(++_blockFill == _blockSize){
+      addBlock(_blockEnergy / _blockSize);
+      _blockEnergy = 0;
+      _blockFill = 0;
+    }
+  }
+
+  _momentary.firstToken() = _momentaryLoudness;
+  _shortTerm.firstToken() = _shortTermLoudness;
+  _integrated.firstToken() = _integratedLoudness;
+  releaseData();
+  return OK;
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#ifndef MLTKLoudness_h
+#define MLTKLoudness_h
+
+#pragma once
+
+#include <vector>
+
+#include "MLTKStatefulAlgorithm.h"
+
+// Streaming EBU R128 loudness meter: momentary (400 ms), short-term (3 s)
+// and integrated loudness of the frame stream, updated every hop, in
+// constant memory however long it runs.
+//
+// The newest hop of each frame goes through the K-weighting filters of
+// ITU-R BS.1770 (the high shelf and the RLB high pass LoudnessEBUR128Filter
+// uses, with their coefficients worked out for the sample rate) once, and
+// its energy is summed into 100 ms sub-blocks. The momentary and short-term
+// windows are running sums over a ring of the last 4 and 30 sub-blocks.
+//
+// Every 100 ms the momentary block is a gating block for the integrated
+// loudness. Instead of keeping them all it sums their count and energy in
+// a histogram of 0.1 LU bins between -70 and +10 LUFS, and the absolute and
+// relative gates are applied to the histogram. Only the relative gate is
+// rounded, to its bin, the energies above it are exact.
+//
+// MLTKCore mixes its input down to one channel, which is metered as the
+// single channel of BS.1770. Readings below the absolute gate of -70 LUFS
+// read -70.
+class MLTKLoudness : public MLTKStatefulAlgorithm {
+ protected:
+  Sink<vector<Real> > _frame;
+  Source<Real> _momentary;
+  Source<Real> _shortTerm;
+  Source<Real> _integrated;
+
+  // the two K-weighting biquads (b0 b1 b2 a1 a2) and their state
+  double _shelf[5], _highPass[5];
+  double _state[4];
+
+  int _blockSize, _blockFill;
+  double _blockEnergy;
+
+  // the last 30 sub-blocks' mean squares (a ring) and the running sums of
+  // the last 4 and 30 of them
+  vector<double> _blocks;
+  int _blockCount, _next;
+  double _momentarySum, _shortTermSum;
+
+  // gating blocks per 0.1 LU bin, and their summed mean squares
+  vector<unsigned long long> _histogram;
+  vector<double> _histogramEnergy;
+  Real _momentaryLoudness, _shortTermLoudness, _integratedLoudness;
+
+  void addBlock(double meanSquare);
+  Real integrate() const;
+
+ public:
+  MLTKLoudness();
+
+  void declareParameters() {
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
+    declareParameter("hopSize", "the number of new samples in each frame", "[1,inf)", 1024);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+  void clear();
+  void skipFrames(int count);
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKLoudness_h */
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#include "MLTKMelody.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* MLTKMelody::name = "MLTKMelody";
+const char* MLTKMelody::category = "Pitch";
+const char* MLTKMelody::description = "This algorithm tracks the predominant melody from a stream of spectral peaks, with a per frame harmonic salience function and a fixed-lag Viterbi over its peaks. The melody comes out a fixed lookahead late.";
+
+// salience bins of 10 cents
+static const Real binCents = 10;
+
+MLTKMelody::MLTKMelody() :
+  _minFrequency(55), _magnitudeThreshold(0), _voicing(0.2), _jump(0.5), _switch(2),
+  _bins(0), _harmonics(20), _candidates(6), _lookahead(0), _frames(0), _peak(0) {
+  setName(name);
+  declareInput(_frequencies, 1, "frequencies", "the frequencies of the frame's spectral peaks [Hz]");
+  declareInput(_magnitudes, 1, "magnitudes", "the magnitudes of the frame's spectral peaks");
+  declareOutput(_pitch, 1, "pitch", "the melody pitch lookahead seconds back [Hz], 0 when unvoiced");
+  declareOutput(_pitchConfidence, 1, "pitchConfidence", "the relative salience of that pitch, 0 when unvoiced");
+  declareParameters();
+}
+
+void MLTKMelody::configure(){
+  _sampleRate = parameter("sampleRate").toReal();
+  _hopSize = parameter("hopSize").toInt();
+  _minFrequency = parameter("minFrequency").toReal();
+  const Real maxFrequency = parameter("maxFrequency").toReal();
+  if(_minFrequency >= maxFrequency){
+    throw EssentiaException("MLTKMelody: minFrequency has to be below maxFrequency");
+  }
+  _bins = (int) ceil(1200 * log2(maxFrequency / _minFrequency) / binCents) + 1;
+  _harmonics = parameter("numberHarmonics").toInt();
+  _magnitudeThreshold = pow(10.0, -parameter("magnitudeThreshold").toReal() / 20);
+  _candidates = parameter("candidates").toInt();
+  _voicing = log(parameter("voicingThreshold").toReal());
+  _jump = parameter("jumpPenalty").toReal() / 100;
+  _switch = parameter("voicingPenalty").toReal();
+  _lookahead = (int) round(parameter("lookahead").toReal() * _sampleRate / _hopSize);
+
+  _spread.resize(21);
+  for(int i = -10; i <= 10; i++){
+    const Real c = cos(M_PI / 2 * i / 10.0);
+    _spread[i + 10] = c * c;
+  }
+  _harmonicWeight.resize(_harmonics);
+  Real weight = 1;
+  for(int h = 0; h < _harmonics; h++, weight *= parameter("harmonicWeight").toReal()){
+    _harmonicWeight[h] = weight;
+  }
+  _salience.resize(_bins);
+
+  // the frames the back pointers reach, plus the one being added: the
+  // Viterbi step still reads the previous frame's candidates, also without
+  // lookahead
+  const int length = _lookahead + 2;
+  const int states = _candidates + 1;
+  _cents.resize(length * _candidates);
+  _strength.resize(length * _candidates);
+  _count.resize(length);
+  _back.resize(length * states);
+  _score.resize(states);
+  _previous.resize(states);
+  clear();
+}
+
+void MLTKMelody::clear(){
+  MLTKStatefulAlgorithm::clear();
+  _frames = 0;
+  _peak = 0;
+}
+
+AlgorithmStatus MLTKMelody::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  nextFrame();
+  const vector<Real> &frequencies = _frequencies.firstToken();
+  const vector<Real> &magnitudes = _magnitudes.firstToken();
+
+  // harmonic summation: every peak votes for the pitches it could be a
+  // harmonic of
+  fill(_salience.begin(), _salience.end(), 0);
+  Real strongest = 0;
+  for(size_t p = 0; p < magnitudes.size(); p++) strongest = max(strongest, magnitudes[p]);
+  for(size_t p = 0; p < frequencies.size() && p < magnitudes.size(); p++){
+    if(frequencies[p] <= 0 || magnitudes[p] < strongest * _magnitudeThreshold) continue;
+    for(int h = 0; h < _harmonics; h++){
+      const Real position = 1200 * log2(frequencies[p] / ((h + 1) * _minFrequency)) / binCents;
+      if(position < -10) break;
+      const int center = (int) round(position);
+      if(center - 10 >= _bins) continue;
+      const Real vote = magnitudes[p] * _harmonicWeight[h];
+      for(int b = max(0, center - 10); b <= min(_bins - 1, center + 10); b++){
+        _salience[b] += vote * _spread[b - center + 10];
+      }
+    }
+  }
+
+  // the strongest local maxima are this hop's candidates
+  const int length = _lookahead + 2;
+  const int slot = _frames % length;
+  Real *cents = &_cents[slot * _candidates];
+  Real *strength = &_strength[slot * _candidates];
+  int &count = _count[slot];
+  count = 0;
+  Real frameMax = 0;
+  for(int b = 1; b + 1 < _bins; b++){
+    const Real s = _salience[b];
+    if(s <= 0 || s < _salience[b - 1] || s < _salience[b + 1]) continue;
+    frameMax = max(frameMax, s);
+    // insertion in decreasing order of salience, the weakest drops out
+    int k;
+    if(count < _candidates) k = count++;
+    else if(strength[_candidates - 1] < s) k = _candidates - 1;
+    else continue;
+    while(k > 0 && strength[k - 1] < s){
+      cents[k] = cents[k - 1];
+      strength[k] = strength[k - 1];
+      k--;
+    }
+    cents[k] = b * binCents;
+    strength[k] = s;
+  }
+
+  // the salience is taken relative to a peak that decays over a few seconds
+  _peak = max((double) frameMax, _peak * exp(-_hopSize / (4 * _sampleRate)));
+  for(int k = 0; k < count; k++) strength[k] = _peak > 0 ? strength[k] / _peak : 0;
+
+  // Viterbi step: the candidates are states 0..count-1, unvoiced is the
+  // last state
+  const int states = _candidates + 1;
+  const int unvoiced = _candidates;
+  int *back = &_back[slot * states];
+  const int previousSlot = (_frames + length - 1) % length;
+  const Real *previousCents = &_cents[previousSlot * _candidates];
+  const int previousCount = _frames > 0 ? _count[previousSlot] : 0;
+  for(int j = 0; j <= count; j++){
+    const int state = j < count ? j : unvoiced;
+    double best = -1e30;
+    int from = unvoiced;
+    if(_frames == 0){
+      best = 0;
+    } else {
+      for(int i = 0; i < previousCount; i++){
+        double s = _previous[i];
+        s -= state == unvoiced ? _switch : _jump * fabs(cents[j] - previousCents[i]);
+        if(s > best){ best = s; from = i; }
+      }
+      const double s = _previous[unvoiced] - (state == unvoiced ? 0 : _switch);
+      if(s > best){ best = s; from = unvoiced; }
+    }
+    _score[state] = best + (state == unvoiced ? _voicing : log(max(strength[j], (Real) 1e-6)));
+    back[state] = from;
+  }
+
+  // keep the scores near 0, only their differences matter
+  double top = _score[unvoiced];
+  int bestState = unvoiced;
+  for(int j = 0; j < count; j++){
+    if(_score[j] > top){ top = _score[j]; bestState = j; }
+  }
+  for(int j = 0; j < count; j++) _previous[j] = _score[j] - top;
+  _previous[unvoiced] = _score[unvoiced] - top;
+  _frames++;
+
+  // back from the best state now to the frame lookahead hops ago
+  Real pitch = 0, confidence = 0;
+  if(_frames > _lookahead){
+    int state = bestState;
+    for(int k = 0; k < _lookahead; k++){
+      state = _back[((_frames - 1 - k) % length) * states + state];
+    }
+    const int past = (_frames - 1 - _lookahead) % length;
+    if(state != unvoiced){
+      pitch = _minFrequency * pow(2.0, _cents[past * _candidates + state] / 1200);
+      confidence = _strength[past * _candidates + state];
+    }
+  }
+
+  _pitch.firstToken() = pitch;
+  _pitchConfidence.firstToken() = confidence;
+  releaseData();
+  return OK;
+}
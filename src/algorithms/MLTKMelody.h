@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#ifndef MLTKMelody_h
+#define MLTKMelody_h
+
+#pragma once
+
+#include <vector>
+
+#include "MLTKStatefulAlgorithm.h"
+
+// Streaming predominant melody in the spirit of PitchMelodia, with a fixed
+// lookahead instead of whole-signal contour tracking.
+//
+// Each hop the spectral peaks vote into a pitch salience function like
+// PitchSalienceFunction's (harmonic summation in 10 cent bins above
+// minFrequency, with cos^2 spreading over a semitone), computed for that
+// frame only. Its strongest local maxima are the hop's pitch candidates,
+// besides an unvoiced state.
+//
+// Tracking is a Viterbi over the candidates that favours small pitch steps
+// and few voicing changes. The forward scores are updated once per hop;
+// the melody of the frame lookahead seconds back is then read by following
+// the back pointers from the best current state. It is the fixed-lag
+// approximation of the full Viterbi path, at a fixed cost per hop and with
+// a delay of exactly lookahead.
+class MLTKMelody : public MLTKStatefulAlgorithm {
+ protected:
+  Sink<vector<Real> > _frequencies;
+  Sink<vector<Real> > _magnitudes;
+  Source<Real> _pitch;
+  Source<Real> _pitchConfidence;
+
+  Real _minFrequency, _magnitudeThreshold, _voicing, _jump, _switch;
+  int _bins, _harmonics, _candidates, _lookahead;
+
+  // cos^2 spreading over +-10 bins, and the weight of each harmonic
+  vector<Real> _spread, _harmonicWeight;
+  vector<Real> _salience;
+
+  // per hop in the ring of lookahead + 2 hops: the candidates' pitch
+  // [cents above minFrequency] and salience, and the back pointers of every
+  // state (the candidates, then unvoiced)
+  vector<Real> _cents, _strength;
+  vector<int> _count, _back;
+  vector<double> _score, _previous;
+  int _frames;
+
+  // running peak of the salience, which the candidates are relative to
+  double _peak;
+
+ public:
+  MLTKMelody();
+
+  void declareParameters() {
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
+    declareParameter("hopSize", "the number of samples between consecutive frames", "[1,inf)", 1024);
+    declareParameter("minFrequency", "the lowest melody pitch [Hz]", "(0,inf)", 55.);
+    declareParameter("maxFrequency", "the highest melody pitch [Hz]", "(0,inf)", 1760.);
+    declareParameter("numberHarmonics", "the number of harmonics each peak votes for", "[1,inf)", 20);
+    declareParameter("harmonicWeight", "the weight ratio of consecutive harmonics", "(0,1)", 0.8);
+    declareParameter("magnitudeThreshold", "peaks this far below the frame's strongest are ignored [dB]", "[0,inf)", 40.);
+    declareParameter("candidates", "the number of salience peaks tracked per hop", "[1,inf)", 6);
+    declareParameter("voicingThreshold", "the relative salience at which voiced and unvoiced score the same", "(0,1)", 0.2);
+    declareParameter("jumpPenalty", "the cost of a pitch step, per semitone", "[0,inf)", 0.5);
+    declareParameter("voicingPenalty", "the cost of switching between voiced and unvoiced", "[0,inf)", 2.);
+    declareParameter("lookahead", "the delay of the melody and the time the tracker looks ahead [s]", "[0,inf)", 0.3);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+  void clear();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKMelody_h */
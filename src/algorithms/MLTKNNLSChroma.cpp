@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#include "MLTKNNLSChroma.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* MLTKNNLSChroma::name = "MLTKNNLSChroma";
+const char* MLTKNNLSChroma::category = "Tonal";
+const char* MLTKNNLSChroma::description = "This algorithm computes treble and bass NNLS chroma from a stream of constant-Q spectra, solving the note decomposition incrementally at a fixed cost per hop, averaged over a fixed lookahead.";
+
+MLTKNNLSChroma::MLTKNNLSChroma() :
+  _binsPerOctave(12), _bins(0), _notes(0), _iterations(8), _firstPitchClass(0), _lookahead(0),
+  _filled(0), _next(0) {
+  setName(name);
+  declareInput(_spectrumCQ, 1, "spectrumCQ", "the constant-Q magnitude spectrum");
+  declareOutput(_chroma, 1, "chroma", "the treble chroma, starting on A, lookahead seconds back");
+  declareOutput(_bassChroma, 1, "bassChroma", "the bass chroma, starting on A, lookahead seconds back");
+  declareParameters();
+}
+
+void MLTKNNLSChroma::configure(){
+  _sampleRate = parameter("sampleRate").toReal();
+  _hopSize = parameter("hopSize").toInt();
+  _binsPerOctave = parameter("binsPerOctave").toInt();
+  if(_binsPerOctave % 12 != 0){
+    throw EssentiaException("MLTKNNLSChroma: binsPerOctave has to be a multiple of 12");
+  }
+  _bins = _binsPerOctave * parameter("numberOfOctaves").toInt();
+  _notes = _bins / (_binsPerOctave / 12);
+  _iterations = parameter("iterations").toInt();
+  _lookahead = (int) round(parameter("lookahead").toReal() * _sampleRate / _hopSize);
+
+  // pitch class of the first bin, counted from A
+  const Real minFrequency = parameter("minFrequency").toReal();
+  _firstPitchClass = ((int) round(12 * log2(minFrequency / 440.0)) % 12 + 12) % 12;
+
+  // note n's harmonics fall 12 * log2(h) semitones above it. A constant-Q
+  // bin still picks up about half of a tone one bin away, so each harmonic
+  // is spread the same way, triangularly over two bins on either side.
+  const Real decay = parameter("harmonicDecay").toReal();
+  const Real binsPerSemitone = _binsPerOctave / 12.0;
+  _dictionary.assign(_bins * _notes, 0);
+  for(int n = 0; n < _notes; n++){
+    Real amplitude = 1;
+    for(int h = 1; h <= 20; h++, amplitude *= decay){
+      const Real position = (n + 12 * log2((Real) h)) * binsPerSemitone;
+      if(position - 2 >= _bins) break;
+      for(int b = max(0, (int) ceil(position - 2)); b <= min(_bins - 1, (int) floor(position + 2)); b++){
+        _dictionary[b * _notes + n] += amplitude * max((Real) 0, 1 - fabs(b - position) / 2);
+      }
+    }
+  }
+  _gram.assign(_notes * _notes, 0);
+  for(int b = 0; b < _bins; b++){
+    const Real *d = &_dictionary[b * _notes];
+    for(int i = 0; i < _notes; i++){
+      if(d[i] == 0) continue;
+      for(int j = 0; j < _notes; j++) _gram[i * _notes + j] += d[i] * d[j];
+    }
+  }
+
+  // bass: a bump over the two lowest octaves analysed above the first
+  _bassWeight.resize(_notes);
+  for(int n = 0; n < _notes; n++){
+    const Real x = (n - 18) / 9.0;
+    _bassWeight[n] = exp(-0.5 * x * x);
+  }
+
+  _whitened.resize(_bins);
+  _activation.resize(_notes);
+  _numerator.resize(_notes);
+  _denominator.resize(_notes);
+  _history.resize((2 * _lookahead + 1) * 24);
+  _sum.resize(24);
+  clear();
+}
+
+void MLTKNNLSChroma::clear(){
+  MLTKStatefulAlgorithm::clear();
+  fill(_activation.begin(), _activation.end(), 0);
+  fill(_history.begin(), _history.end(), 0);
+  fill(_sum.begin(), _sum.end(), 0);
+  _filled = 0;
+  _next = 0;
+}
+
+AlgorithmStatus MLTKNNLSChroma::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  nextFrame();
+  const vector<Real> &spectrum = _spectrumCQ.firstToken();
+  if((int) spectrum.size() != _bins){
+    throw EssentiaException("MLTKNNLSChroma: the constant-Q spectrum doesn't match binsPerOctave and numberOfOctaves");
+  }
+
+  // whitening: what stands out of the local mean, in units of the local
+  // deviation, over an octave of bins around each
+  const int radius = _binsPerOctave / 2;
+  double sum = 0, squares = 0;
+  int from = 0, to = 0;
+  for(int b = 0; b < _bins; b++){
+    while(to < _bins && to <= b + radius){
+      sum += spectrum[to];
+      squares += spectrum[to] * spectrum[to];
+      to++;
+    }
+    while(from < b - radius){
+      sum -= spectrum[from];
+      squares -= spectrum[from] * spectrum[from];
+      from++;
+    }
+    const int count = to - from;
+    const double mean = sum / count;
+    const double deviation = sqrt(max(0.0, squares / count - mean * mean));
+    _whitened[b] = deviation > 0 ? max(0.0, (spectrum[b] - mean) / deviation) : 0;
+  }
+
+  // multiplicative updates of min |D a - y|, a >= 0, from the last hop's
+  // activations, a note that went to zero gets a small start again
+  for(int n = 0; n < _notes; n++){
+    double v = 0;
+    for(int b = 0; b < _bins; b++) v += _dictionary[b * _notes + n] * _whitened[b];
+    _numerator[n] = v;
+    _activation[n] = max(_activation[n], (Real) 1e-3);
+  }
+  for(int iteration = 0; iteration < _iterations; iteration++){
+    for(int i = 0; i < _notes; i++){
+      const Real *g = &_gram[i * _notes];
+      double v = 0;
+      for(int j = 0; j < _notes; j++) v += g[j] * _activation[j];
+      _denominator[i] = v;
+    }
+    for(int n = 0; n < _notes; n++){
+      _activation[n] *= _numerator[n] / (_denominator[n] + 1e-9);
+    }
+  }
+
+  // fold into the ring of chroma, treble and bass
+  Real *chroma = &_history[_next * 24];
+  for(int i = 0; i < 24; i++) _sum[i] -= chroma[i];
+  fill(chroma, chroma + 24, 0);
+  for(int n = 0; n < _notes; n++){
+    const int pitchClass = (_firstPitchClass + n) % 12;
+    chroma[pitchClass] += _activation[n] * (1 - _bassWeight[n]);
+    chroma[12 + pitchClass] += _activation[n] * _bassWeight[n];
+  }
+  for(int i = 0; i < 24; i++) _sum[i] += chroma[i];
+  const int length = 2 * _lookahead + 1;
+  _next = (_next + 1) % length;
+  if(_filled < length) _filled++;
+
+  // rebuilt once per lap, so rounding errors don't pile up
+  if(_next == 0){
+    fill(_sum.begin(), _sum.end(), 0);
+    for(int k = 0; k < length; k++){
+      for(int i = 0; i < 24; i++) _sum[i] += _history[k * 24 + i];
+    }
+  }
+
+  // averages of the window centered lookahead hops back, at a maximum of 1
+  vector<Real> &treble = _chroma.firstToken();
+  vector<Real> &bass = _bassChroma.firstToken();
+  treble.assign(_sum.begin(), _sum.begin() + 12);
+  bass.assign(_sum.begin() + 12, _sum.end());
+  const Real trebleMax = *max_element(treble.begin(), treble.end());
+  const Real bassMax = *max_element(bass.begin(), bass.end());
+  if(trebleMax > 0) for(Real &c : treble) c /= trebleMax;
+  if(bassMax > 0) for(Real &c : bass) c /= bassMax;
+
+  releaseData();
+  return OK;
+}
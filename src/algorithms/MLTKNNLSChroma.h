@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#ifndef MLTKNNLSChroma_h
+#define MLTKNNLSChroma_h
+
+#pragma once
+
+#include <vector>
+
+#include "MLTKStatefulAlgorithm.h"
+
+// Streaming NNLS chroma (Mauch & Dixon, 2010) on MLTKConstantQ's spectrum,
+// with a fixed lookahead.
+//
+// Each hop the constant-Q magnitudes are whitened against their running
+// mean and deviation over an octave of neighbouring bins, and explained as
+// a non-negative mix of note profiles, one per semitone with geometrically
+// decaying harmonics. The mix is solved approximately with a fixed number
+// of multiplicative updates started from the previous hop's solution, which
+// changes little from one hop to the next, so the cost per hop is fixed.
+// The note activations fold into a treble and a bass chroma, starting on A
+// like NNLSChroma's.
+//
+// Both chroma are averaged over lookahead seconds on either side, and come
+// out that much later: the values of each hop describe the frame
+// lookahead seconds back.
+class MLTKNNLSChroma : public MLTKStatefulAlgorithm {
+ protected:
+  Sink<vector<Real> > _spectrumCQ;
+  Source<vector<Real> > _chroma;
+  Source<vector<Real> > _bassChroma;
+
+  int _binsPerOctave, _bins, _notes, _iterations, _firstPitchClass, _lookahead;
+
+  // the note profiles (bins x notes), their gram matrix (notes x notes), and
+  // the bass weight of each note
+  vector<Real> _dictionary, _gram, _bassWeight;
+
+  vector<Real> _whitened, _activation, _numerator, _denominator;
+
+  // the last 2 * lookahead + 1 hops' chroma (a ring, treble then bass) and
+  // their sum
+  vector<Real> _history, _sum;
+  int _filled, _next;
+
+ public:
+  MLTKNNLSChroma();
+
+  void declareParameters() {
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
+    declareParameter("hopSize", "the number of samples between consecutive spectra", "[1,inf)", 1024);
+    declareParameter("minFrequency", "the frequency of the first constant-Q bin [Hz]", "(0,inf)", 32.7032);
+    declareParameter("binsPerOctave", "the constant-Q bins per octave, a multiple of 12", "[12,inf)", 12);
+    declareParameter("numberOfOctaves", "the number of constant-Q octaves", "[1,inf)", 7);
+    declareParameter("harmonicDecay", "the amplitude ratio of consecutive harmonics in the note profiles", "(0,1)", 0.7);
+    declareParameter("iterations", "the number of multiplicative updates per hop", "[1,inf)", 8);
+    declareParameter("lookahead", "the time each chroma is averaged over on either side, and its delay [s]", "[0,inf)", 0.3);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+  void clear();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKNNLSChroma_h */
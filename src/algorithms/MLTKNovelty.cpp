@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "MLTKNovelty.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* MLTKNovelty::name = "MLTKNovelty";
+const char* MLTKNovelty::category = "Rhythm";
+const char* MLTKNovelty::description = "This algorithm computes an onset novelty function from a stream of magnitude spectra, the half wave rectified log magnitude flux against a maximum filtered earlier spectrum (SuperFlux). Its state survives network resets.";
+
+MLTKNovelty::MLTKNovelty() : _compression(100), _lag(1), _maxFilterWidth(3), _filled(0), _frames(0) {
+  setName(name);
+  declareInput(_spectrum, 1, "spectrum", "the magnitude spectrum, one per hop");
+  declareOutput(_novelty, 1, "novelty", "the onset novelty of this hop");
+  declareParameters();
+}
+
+void MLTKNovelty::configure(){
+  _hopSize = parameter("hopSize").toInt();
+  _compression = parameter("compression").toReal();
+  _lag = parameter("lag").toInt();
+  _maxFilterWidth = parameter("maxFilterWidth").toInt();
+  _history.resize(_lag);
+  clear();
+}
+
+void MLTKNovelty::clear(){
+  MLTKStatefulAlgorithm::clear();
+  _filled = 0;
+  _frames = 0;
+}
+
+void MLTKNovelty::skipFrames(int count){
+  MLTKStatefulAlgorithm::clear();
+  if(_filled == 0 || count <= 0) return;
+
+  // the spectra before the gap were silent, what comes after rises from 0
+  for(vector<Real> &earlier : _history) earlier.assign(_current.size(), 0);
+  _filled = _lag;
+}
+
+AlgorithmStatus MLTKNovelty::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  nextFrame();
+  const vector<Real> &spectrum = _spectrum.firstToken();
+  _current.resize(spectrum.size());
+  for(size_t k = 0; k < spectrum.size(); k++){
+    _current[k] = log10(1 + _compression * spectrum[k]);
+  }
+
+  // a new spectrum size starts the history over
+  vector<Real> &earlier = _history[_frames++ % _lag];
+  if(!earlier.empty() && earlier.size() != _current.size()){
+    for(vector<Real> &h : _history) h.clear();
+    _filled = 0;
+  }
+
+  // nothing to compare with until lag spectra have gone by
+  Real novelty = 0;
+  if(_filled == _lag){
+    for(size_t k = 0; k < _current.size(); k++){
+      const Real rise = _current[k] - earlier[k];
+      if(rise > 0) novelty += rise;
+    }
+  } else {
+    _filled++;
+  }
+
+  // this spectrum takes the oldest one's place, max filtered
+  const int size = _current.size();
+  const int radius = _maxFilterWidth / 2;
+  earlier.resize(size);
+  for(int k = 0; k < size; k++){
+    Real m = _current[k];
+    for(int j = max(0, k - radius); j <= min(size - 1, k + radius); j++){
+      if(_current[j] > m) m = _current[j];
+    }
+    earlier[k] = m;
+  }
+
+  _novelty.firstToken() = novelty;
+  releaseData();
+  return OK;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef MLTKNovelty_h
+#define MLTKNovelty_h
+
+#pragma once
+
+#include <vector>
+
+#include "MLTKStatefulAlgorithm.h"
+
+// Onset novelty of a magnitude spectrum stream, one value per hop: the
+// half wave rectified increase of the log compressed magnitudes over the
+// spectrum lag hops earlier, summed over the bins. Keeps its history across
+// network resets, so it works in MLTKCore's per-hop network where Flux
+// would start over on every run().
+//
+// As in SuperFlux (Boeck & Widmer, 2013) the earlier spectrum goes through
+// a maximum filter over frequency first, so the slow pitch changes of
+// vibrato and glissandi don't count as onsets. maxFilterWidth 1 and lag 1
+// give the plain spectral flux.
+class MLTKNovelty : public MLTKStatefulAlgorithm {
+ protected:
+  Sink<vector<Real> > _spectrum;
+  Source<Real> _novelty;
+
+  Real _compression;
+  int _lag, _maxFilterWidth;
+
+  // the max filtered spectra of the last lag hops (a ring), and how many
+  // of them are filled
+  vector<vector<Real> > _history;
+  int _filled;
+  unsigned long long _frames;
+  vector<Real> _current;
+
+ public:
+  MLTKNovelty();
+
+  void declareParameters() {
+    declareParameter("hopSize", "the number of samples between consecutive spectra", "[1,inf)", 1024);
+    declareParameter("compression", "the magnitudes are compressed as log10(1 + compression * magnitude), the default suits normalized spectra", "(0,inf)", 100.);
+    declareParameter("lag", "the number of hops between the spectra compared", "[1,inf)", 1);
+    declareParameter("maxFilterWidth", "the width of the maximum filter over frequency applied to the earlier spectrum [bins]", "[1,inf)", 3);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+  void clear();
+  void skipFrames(int count);
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKNovelty_h */
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#include "MLTKOnsetDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* MLTKOnsetDetector::name = "MLTKOnsetDetector";
+const char* MLTKOnsetDetector::category = "Rhythm";
+const char* MLTKOnsetDetector::description = "This algorithm picks onsets causally from an onset novelty stream with a running median threshold, and places them within the frame to the sample where the signal power steps up. Onsets are posted as events.";
+
+MLTKOnsetDetector::MLTKOnsetDetector() :
+  _ratio(1.5), _delta(1.5), _blockSize(64), _minInterval(0), _filled(0), _next(0),
+  _above(false), _lastOnset(0), _any(false) {
+  setName(name);
+  declareInput(_noveltyInput, 1, "novelty", "the onset novelty, one value per hop");
+  declareInput(_frame, 1, "frame", "the audio frame the novelty was computed from");
+  declareOutput(_onset, 1, "onset", "1 when an onset was posted during this hop, 0 otherwise");
+  declareParameters();
+}
+
+void MLTKOnsetDetector::configure(){
+  _sampleRate = parameter("sampleRate").toReal();
+  _hopSize = parameter("hopSize").toInt();
+  _ratio = parameter("ratio").toReal();
+  _delta = parameter("delta").toReal();
+  _blockSize = parameter("blockSize").toInt();
+  _minInterval = (int) round(parameter("minInterval").toReal() * _sampleRate);
+
+  const int length = max(1, (int) round(parameter("medianWindow").toReal() * _sampleRate / _hopSize));
+  _ring.resize(length);
+  _sorted.reserve(length);
+  clear();
+}
+
+void MLTKOnsetDetector::clear(){
+  MLTKStatefulAlgorithm::clear();
+  _sorted.clear();
+  _filled = 0;
+  _next = 0;
+  _above = false;
+  _any = false;
+}
+
+void MLTKOnsetDetector::skipFrames(int count){
+  MLTKStatefulAlgorithm::clear();
+  const int length = _ring.size();
+  for(int i = 0; i < min(count, length); i++) push(0);
+  _above = false;
+}
+
+Real MLTKOnsetDetector::median() const {
+  const int n = _sorted.size();
+  if(n == 0) return 0;
+  return n % 2 ? _sorted[n / 2] : (Real) 0.5 * (_sorted[n / 2 - 1] + _sorted[n / 2]);
+}
+
+void MLTKOnsetDetector::push(Real novelty){
+  // the oldest value leaves the sorted copy once the ring is full
+  if(_filled == (int) _ring.size()){
+    _sorted.erase(lower_bound(_sorted.begin(), _sorted.end(), _ring[_next]));
+  } else {
+    _filled++;
+  }
+  _ring[_next] = novelty;
+  _next = (_next + 1) % _ring.size();
+  _sorted.insert(upper_bound(_sorted.begin(), _sorted.end(), novelty), novelty);
+}
+
+unsigned long long MLTKOnsetDetector::locate(const vector<Real> &frame){
+  const int blocks = frame.size() / _blockSize;
+  _energy.resize(blocks);
+  for(int b = 0; b < blocks; b++){
+    const Real *x = &frame[b * _blockSize];
+    Real e = 0;
+    for(int i = 0; i < _blockSize; i++) e += x[i] * x[i];
+    _energy[b] = e;
+  }
+
+  // the largest jump over the two blocks before, which steps over the
+  // ripple low tones leave in the block energies, after the last onset
+  int best = -1;
+  Real strongest = 0;
+  for(int b = 1; b < blocks; b++){
+    const unsigned long long position = _frameStart + (unsigned long long) b * _blockSize;
+    if(_any && position < _lastOnset + _minInterval) continue;
+    const Real before = max(_energy[b - 1], b > 1 ? _energy[b - 2] : _energy[b - 1]);
+    const Real jump = _energy[b] - before;
+    if(jump > strongest){
+      strongest = jump;
+      best = b;
+    }
+  }
+
+  // nothing rises in the frame, the onset is in its newest hop
+  if(best < 0) return _frameStart + max(0, (int) frame.size() - _hopSize);
+
+  // the attack starts in that block or late in the one before: the onset
+  // is the sample where the mean power after it rises most over the mean
+  // power before it, which for a step in level is the step itself
+  const int begin = (best - 1) * _blockSize;
+  const int end = min((int) frame.size(), (best + 1) * _blockSize);
+  const int margin = max(1, _blockSize / 8);
+  Real total = 0;
+  for(int i = begin; i < end; i++) total += frame[i] * frame[i];
+
+  int onset = best * _blockSize;
+  Real before = 0, contrast = 0;
+  for(int i = begin; i < end; i++){
+    if(i - begin >= margin && end - i >= margin){
+      const Real rise = (total - before) / (end - i) - before / (i - begin);
+      if(rise > contrast){
+        contrast = rise;
+        onset = i;
+      }
+    }
+    before += frame[i] * frame[i];
+  }
+  return _frameStart + (unsigned long long) onset;
+}
+
+AlgorithmStatus MLTKOnsetDetector::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  nextFrame();
+  const Real novelty = _noveltyInput.firstToken();
+  const vector<Real> &frame = _frame.firstToken();
+
+  // the threshold only looks at earlier hops
+  const Real threshold = _ratio * median() + _delta;
+  const bool above = novelty > threshold;
+  push(novelty);
+
+  Real onset = 0;
+  if(above && !_above){
+    const unsigned long long sample = locate(frame);
+    if(!_any || sample >= _lastOnset + _minInterval){
+      emit("onset", sample, novelty);
+      _lastOnset = sample;
+      _any = true;
+      onset = 1;
+    }
+  }
+  _above = above;
+
+  _onset.firstToken() = onset;
+  releaseData();
+  return OK;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#ifndef MLTKOnsetDetector_h
+#define MLTKOnsetDetector_h
+
+#pragma once
+
+#include <vector>
+
+#include "MLTKStatefulAlgorithm.h"
+
+// Causal onset picker over an onset novelty stream (MLTKNovelty), one value
+// per hop, posting "onset" events (value: novelty) as soon as the hop that
+// shows them has been analysed.
+//
+// A hop is an onset when its novelty rises above the running median of the
+// last medianWindow seconds, times ratio, plus delta, and the hop before
+// didn't. The median is kept sorted next to the ring of novelty values, so
+// each hop costs one insertion and one removal.
+//
+// The spectra only place an onset somewhere within the frame, so the frame
+// itself is searched for the block of blockSize samples whose energy jumps
+// the most. Within that block and the one before it, the onset is the
+// sample where the mean power after it rises most over the mean power
+// before it. An abrupt onset (a click, a struck or noisy attack) is placed
+// to within a few samples; a gradual attack is placed part way up its
+// ramp, so a 2 ms fade-in comes out about 1-2 ms late.
+class MLTKOnsetDetector : public MLTKStatefulAlgorithm {
+ protected:
+  Sink<Real> _noveltyInput;
+  Sink<vector<Real> > _frame;
+  Source<Real> _onset;
+
+  Real _ratio, _delta;
+  int _blockSize, _minInterval;
+
+  // the novelty of the last hops (a ring) and the same values sorted
+  vector<Real> _ring, _sorted;
+  int _filled, _next;
+
+  bool _above;
+  unsigned long long _lastOnset;
+  bool _any;
+
+  vector<Real> _energy;
+
+  Real median() const;
+  void push(Real novelty);
+  unsigned long long locate(const vector<Real> &frame);
+
+ public:
+  MLTKOnsetDetector();
+
+  void declareParameters() {
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
+    declareParameter("hopSize", "the number of samples between consecutive novelty values", "[1,inf)", 1024);
+    declareParameter("medianWindow", "the length of the running median threshold [s]", "(0,inf)", 0.25);
+    declareParameter("ratio", "the factor applied to the running median", "[0,inf)", 1.5);
+    declareParameter("delta", "the amount added to the threshold", "[0,inf)", 1.5);
+    declareParameter("minInterval", "the shortest time between two onsets [s]", "[0,inf)", 0.03);
+    declareParameter("blockSize", "the size of the blocks the frame is searched in for the energy jump, the position is then refined to a sample within it [samples]", "[1,inf)", 64);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+  void clear();
+  void skipFrames(int count);
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKOnsetDetector_h */
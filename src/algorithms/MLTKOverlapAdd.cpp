@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "MLTKOverlapAdd.h"
+
+#include <algorithm>
+
+const char* MLTKOverlapAdd::name = "MLTKOverlapAdd";
+const char* MLTKOverlapAdd::category = "Synthesis";
+const char* MLTKOverlapAdd::description = "This algorithm overlap-adds resynthesized frames into an output ring, at their position in the input stream, undoing the analysis window.";
+
+MLTKOverlapAdd::MLTKOverlapAdd() :
+  _frameSize(0), _zeroPhase(true), _gain(1), _output(0) {
+  setName(name);
+  declareInput(_frame, 1, "frame", "the resynthesized frame, windowed like the analysis frame");
+  declareParameters();
+}
+
+void MLTKOverlapAdd::configure(){
+  _frameSize = parameter("frameSize").toInt();
+  _hopSize = parameter("hopSize").toInt();
+  _zeroPhase = parameter("zeroPhase").toBool();
+  _gain = parameter("gain").toReal();
+
+  MLTKTables::Handle window = MLTKTables::window(parameter("type").toString(), _frameSize,
+                                                 parameter("normalized").toBool());
+  _envelope.assign(_hopSize, 0);
+  for(int i = 0; i < _frameSize; i++) _envelope[i % _hopSize] += (*window)[i];
+  _buffer.resize(_frameSize);
+  clear();
+}
+
+void MLTKOverlapAdd::setOutput(MLTKOutputRing *output){
+  _output = output;
+}
+
+AlgorithmStatus MLTKOverlapAdd::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  nextFrame();
+  const vector<Real> &frame = _frame.firstToken();
+  if((int) frame.size() != _frameSize){
+    throw EssentiaException("MLTKOverlapAdd: the frame size doesn't match frameSize");
+  }
+
+  if(_output != NULL){
+    // the first half of a zero phase frame is the second half of the signal
+    const int half = _zeroPhase ? _frameSize / 2 : 0;
+    for(int i = 0; i < _frameSize; i++){
+      const Real x = frame[(i - half + _frameSize) % _frameSize];
+      const Real w = _envelope[i % _hopSize];
+      _buffer[i] = w > 1e-6 ? _gain * x / w : 0;
+    }
+    _output->add(_frameStart, &_buffer[0], _frameSize);
+    _output->commit(_frameStart + _hopSize);
+  }
+
+  releaseData();
+  return OK;
+}
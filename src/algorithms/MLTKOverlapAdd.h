@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef MLTKOverlapAdd_h
+#define MLTKOverlapAdd_h
+
+#pragma once
+
+#include <vector>
+
+#include "MLTKStatefulAlgorithm.h"
+
+#include "ofxMLTKOutputRing.h"
+#include "ofxMLTKTables.h"
+
+// Overlap-add sink of a resynthesis chain: takes the windowed frames coming
+// out of an IFFT, one per hop, and adds them into an MLTKOutputRing at
+// their position in the input stream, where the sound card's output
+// callback picks them up. Used in place of OverlapAdd, which keeps its sum
+// in a buffer that every network reset would empty.
+//
+// The frames are rotated back if the analysis windowing was zero phase and
+// divided by the overlapped analysis window, so a frame that went through
+// FFT -> IFFT unchanged comes out as the input signal.
+class MLTKOverlapAdd : public MLTKStatefulAlgorithm {
+ protected:
+  Sink<vector<Real> > _frame;
+
+  int _frameSize;
+  bool _zeroPhase;
+  Real _gain;
+
+  // the sum of the overlapping windows at each position within a hop
+  vector<Real> _envelope;
+  vector<float> _buffer;
+
+  MLTKOutputRing *_output;
+
+ public:
+  MLTKOverlapAdd();
+
+  void declareParameters() {
+    declareParameter("frameSize", "the size of the frames", "[1,inf)", 2048);
+    declareParameter("hopSize", "the number of samples between consecutive frames", "[1,inf)", 1024);
+    declareParameter("type", "the window the frames were analysed with", "{hann,hamming,triangular,square,blackmanharris62,blackmanharris70,blackmanharris74,blackmanharris92}", "hann");
+    declareParameter("normalized", "whether the analysis window was normalized to a sum of 2", "{true,false}", true);
+    declareParameter("zeroPhase", "whether the analysis frames were rotated for zero phase", "{true,false}", true);
+    declareParameter("gain", "the output gain", "[0,inf)", 1.);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+
+  // Where the frames go, nothing is written without one
+  void setOutput(MLTKOutputRing *output);
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKOverlapAdd_h */
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#include "MLTKPitchYin.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* MLTKPitchYin::name = "MLTKPitchYin";
+const char* MLTKPitchYin::category = "Pitch";
+const char* MLTKPitchYin::description = "This algorithm estimates the pitch of frames with YIN, computing the difference function from an FFT autocorrelation with shared plans. Several frames can be processed in one call.";
+
+MLTKPitchYin::MLTKPitchYin() :
+  _frameSize(0), _fftSize(0), _minLag(0), _maxLag(0), _sampleRate(44100), _tolerance(0.15), _interpolate(true) {
+  setName(name);
+  declareInput(_frame, 1, "frame", "the input audio frame");
+  declareOutput(_pitch, 1, "pitch", "the pitch of the frame [Hz], 0 when silent");
+  declareOutput(_pitchConfidence, 1, "pitchConfidence", "how periodic the frame is, between 0 and 1");
+  declareParameters();
+}
+
+MLTKPitchYin::~MLTKPitchYin(){
+  releaseBuffers();
+}
+
+void MLTKPitchYin::releaseBuffers(){
+  for(float *in : _in) MLTKFFT::free(in);
+  for(fftwf_complex *spectrum : _spectrum) MLTKFFT::free(spectrum);
+  _in.clear();
+  _spectrum.clear();
+}
+
+void MLTKPitchYin::configure(){
+  _frameSize = parameter("frameSize").toInt();
+  _sampleRate = parameter("sampleRate").toReal();
+  _tolerance = parameter("tolerance").toReal();
+  _interpolate = parameter("interpolate").toBool();
+
+  const Real minFrequency = parameter("minFrequency").toReal();
+  const Real maxFrequency = parameter("maxFrequency").toReal();
+  if(minFrequency >= maxFrequency){
+    throw EssentiaException("MLTKPitchYin: minFrequency has to be below maxFrequency");
+  }
+  _minLag = max(2, (int) floor(_sampleRate / maxFrequency));
+  _maxLag = min(_frameSize / 2, (int) ceil(_sampleRate / minFrequency));
+  if(_minLag >= _maxLag){
+    throw EssentiaException("MLTKPitchYin: the frame is too short for this frequency range");
+  }
+
+  // long enough that lags up to maxLag don't wrap around
+  _fftSize = 1;
+  while(_fftSize < _frameSize + _maxLag) _fftSize *= 2;
+  _forward = MLTKFFT::plan(_fftSize, MLTKFFT::REAL_FORWARD);
+  _inverse = MLTKFFT::plan(_fftSize, MLTKFFT::REAL_INVERSE);
+
+  releaseBuffers();
+  _squares.resize(_frameSize + 1);
+  _difference.resize(_maxLag + 2);
+}
+
+void MLTKPitchYin::reserve(int count){
+  while((int) _in.size() < count){
+    _in.push_back(MLTKFFT::allocReal(_fftSize));
+    _spectrum.push_back(MLTKFFT::allocComplex(_fftSize / 2 + 1));
+  }
+}
+
+void MLTKPitchYin::compute(const vector<vector<Real> > &frames, vector<Real> &pitch, vector<Real> &confidence){
+  const int count = frames.size();
+  reserve(count);
+  pitch.resize(count);
+  confidence.resize(count);
+  for(int f = 0; f < count; f++){
+    analyze(frames[f], f, pitch[f], confidence[f]);
+  }
+}
+
+void MLTKPitchYin::analyze(const vector<Real> &frame, int slot, Real &pitch, Real &confidence){
+  const int size = min((int) frame.size(), _frameSize);
+  float *in = _in[slot];
+  if(size > 0) copy(frame.begin(), frame.begin() + size, in);
+  fill(in + size, in + _fftSize, 0.f);
+  _forward->execute(in, _spectrum[slot]);
+
+  // the power spectrum, transformed back, is the autocorrelation
+  float *bin = (float*) _spectrum[slot];
+  for(int k = 0; k < _fftSize / 2 + 1; k++){
+    bin[2 * k] = bin[2 * k] * bin[2 * k] + bin[2 * k + 1] * bin[2 * k + 1];
+    bin[2 * k + 1] = 0;
+  }
+  _inverse->execute(_spectrum[slot], in);
+
+  pick(in, size > 0 ? &frame[0] : 0, size, pitch, confidence);
+}
+
+void MLTKPitchYin::pick(const float *autocorrelation, const Real *frame, int size, Real &pitch, Real &confidence){
+  pitch = 0;
+  confidence = 0;
+
+  // running sum of squares, so e(a, b) = squares[b] - squares[a]
+  double energy = 0;
+  _squares[0] = 0;
+  for(int i = 0; i < size; i++){
+    energy += (double) frame[i] * frame[i];
+    _squares[i + 1] = energy;
+  }
+  const int maxLag = min(_maxLag, size / 2);
+  if(energy <= 0 || maxLag <= _minLag) return;
+
+  // the inverse transform is unnormalized
+  const double scale = 1.0 / _fftSize;
+  const double *e = &_squares[0];
+  Real *d = &_difference[0];
+
+  // cumulative mean normalized difference, only the lags in range are kept
+  double sum = 0;
+  d[0] = 1;
+  for(int t = 1; t <= maxLag + 1 && t < size; t++){
+    const double value = max(0.0, e[size - t] + (e[size] - e[t]) - 2 * scale * autocorrelation[t]);
+    sum += value;
+    d[t] = sum > 0 ? value * t / sum : 1;
+  }
+
+  // the first dip below the tolerance, followed down to its minimum, or
+  // the lowest point if there is none
+  int lag = -1;
+  for(int t = _minLag; t <= maxLag; t++){
+    if(d[t] < _tolerance){
+      while(t + 1 <= maxLag && d[t + 1] < d[t]) t++;
+      lag = t;
+      break;
+    }
+  }
+  if(lag < 0){
+    lag = _minLag;
+    for(int t = _minLag + 1; t <= maxLag; t++){
+      if(d[t] < d[lag]) lag = t;
+    }
+  }
+
+  Real period = lag;
+  Real minimum = d[lag];
+  if(_interpolate && lag > 1 && lag + 1 < size){
+    const Real a = d[lag - 1], b = d[lag], c = d[lag + 1];
+    const Real curvature = a - 2 * b + c;
+    if(curvature > 0){
+      const Real offset = 0.5 * (a - c) / curvature;
+      period += offset;
+      minimum = b - 0.25 * (a - c) * offset;
+    }
+  }
+
+  pitch = _sampleRate / period;
+  confidence = min((Real) 1, max((Real) 0, 1 - minimum));
+}
+
+AlgorithmStatus MLTKPitchYin::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  reserve(1);
+  analyze(_frame.firstToken(), 0, _pitch.firstToken(), _pitchConfidence.firstToken());
+  releaseData();
+  return OK;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#ifndef MLTKPitchYin_h
+#define MLTKPitchYin_h
+
+#pragma once
+
+#include <vector>
+
+#include "streaming/streamingalgorithm.h"
+
+#include "ofxMLTKFFT.h"
+
+using namespace std;
+using namespace essentia;
+using namespace streaming;
+
+// YIN pitch (de Cheveigne & Kawahara) with the difference function computed
+// through an FFT autocorrelation, at a fixed cost per frame.
+//
+// The frame is zero padded to a power of two above frameSize plus the
+// longest lag, so one real FFT, the power spectrum and one inverse FFT give
+// its autocorrelation r without wrap around. The difference function is
+// then d(t) = e(0, W-t) + e(t, W) - 2 r(t), with the energies e taken from
+// a running sum of squares, as in PitchYinFFT. Both FFTs use MLTKFFT's
+// shared plans, so any number of instances and channels share them.
+//
+// compute() takes several frames at once, for example one per performer,
+// and runs them through the same plans back to back on buffers kept from
+// call to call, so one instance serves every channel. The streaming side
+// handles one frame per token.
+//
+// Outputs follow PitchYin: pitch is 0 for silent frames, and the
+// confidence is 1 minus the cumulative mean normalized difference at the
+// chosen lag.
+class MLTKPitchYin : public Algorithm {
+ protected:
+  Sink<vector<Real> > _frame;
+  Source<Real> _pitch;
+  Source<Real> _pitchConfidence;
+
+  int _frameSize, _fftSize, _minLag, _maxLag;
+  Real _sampleRate, _tolerance;
+  bool _interpolate;
+
+  MLTKFFT::Handle _forward, _inverse;
+
+  // one set of FFT buffers per frame of the largest batch so far
+  vector<float*> _in;
+  vector<fftwf_complex*> _spectrum;
+  vector<double> _squares;
+  vector<Real> _difference;
+
+  void reserve(int count);
+  void releaseBuffers();
+  void analyze(const vector<Real> &frame, int slot, Real &pitch, Real &confidence);
+  void pick(const float *autocorrelation, const Real *frame, int size, Real &pitch, Real &confidence);
+
+ public:
+  MLTKPitchYin();
+  ~MLTKPitchYin();
+
+  void declareParameters() {
+    declareParameter("frameSize", "the expected frame size, shorter frames are zero padded and longer ones cut", "[2,inf)", 2048);
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
+    declareParameter("minFrequency", "the lowest pitch searched [Hz], at least two periods have to fit in the frame", "(0,inf)", 20.);
+    declareParameter("maxFrequency", "the highest pitch searched [Hz]", "(0,inf)", 22050.);
+    declareParameter("tolerance", "the threshold of the cumulative mean normalized difference below which the first dip is taken", "[0,1]", 0.15);
+    declareParameter("interpolate", "whether to refine the lag by parabolic interpolation", "{true,false}", true);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+
+  // Pitch and confidence of each frame, in one pass over the shared plans
+  void compute(const vector<vector<Real> > &frames, vector<Real> &pitch, vector<Real> &confidence);
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKPitchYin_h */
@@ -0,0 +1,348 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "MLTKQCMonitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+#include "algorithmfactory.h"
+
+// CPU time of the calling thread, as MLTKEngine measures its instances, so
+// the analysis thread being preempted isn't charged to a detector
+static double threadCPUTime(){
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+const char* MLTKQCMonitor::name = "MLTKQCMonitor";
+const char* MLTKQCMonitor::category = "Audio Problems";
+const char* MLTKQCMonitor::description = "This algorithm runs Essentia's audio problem detectors continuously over a frame stream, skips them on silent input, posts the incidents they find as events and measures the CPU time each of them takes.";
+
+MLTKQCMonitor::MLTKQCMonitor() :
+  _silenceThreshold(-70), _silenceHold(0), _minInterval(0), _heard(false), _lastSound(0),
+  _truePeakHops(1), _truePeakCountdown(0), _truePeakGate(0),
+  _humFilled(0), _humNext(0), _humInterval(1), _humCountdown(0), _humFactor(1), _humPhase(0), _cpuDecay(0) {
+  setName(name);
+  declareInput(_frame, 1, "frame", "the input audio frame");
+  declareOutput(_cpu, 1, "cpu", "the share of one core each detector takes");
+  declareOutput(_active, 1, "active", "1 when the gated detectors ran on this frame, 0 when the input was silent");
+  declareParameters();
+
+  const char *types[DETECTORS] = { "click", "discontinuity", "saturation", "gap", "noiseBurst", "truePeak", "hum" };
+  for(int i = 0; i < DETECTORS; i++){
+    _detectors[i].type = types[i];
+    _detectors[i].algorithm = NULL;
+  }
+}
+
+MLTKQCMonitor::~MLTKQCMonitor(){
+  destroy();
+}
+
+void MLTKQCMonitor::destroy(){
+  for(Detector &d : _detectors){
+    delete d.algorithm;
+    d.algorithm = NULL;
+  }
+}
+
+void MLTKQCMonitor::configure(){
+  _sampleRate = parameter("sampleRate").toReal();
+  _hopSize = parameter("hopSize").toInt();
+  const int frameSize = parameter("frameSize").toInt();
+  _silenceThreshold = parameter("silenceThreshold").toReal();
+  _silenceHold = (int) round(parameter("silenceHold").toReal() * _sampleRate);
+  _minInterval = (int) round(parameter("minInterval").toReal() * _sampleRate);
+  _truePeakHops = max(1, frameSize / _hopSize);
+
+  // the hum ring is low-passed at 1 kHz (fourth order Butterworth) and
+  // decimated to about 4 kHz
+  _humFactor = max(1, (int) (_sampleRate / 4000));
+  const Real humRate = _sampleRate / _humFactor;
+  const double cutoff = min(1000.0, 0.25 * humRate);
+  const double q[2] = { 0.5412, 1.3066 };
+  for(int b = 0; b < 2; b++){
+    const double w = 2 * M_PI * cutoff / _sampleRate;
+    const double alpha = sin(w) / (2 * q[b]);
+    const double a0 = 1 + alpha;
+    double *c = _humCoefficients[b];
+    c[0] = (1 - cos(w)) / 2 / a0;
+    c[1] = (1 - cos(w)) / a0;
+    c[2] = c[0];
+    c[3] = -2 * cos(w) / a0;
+    c[4] = (1 - alpha) / a0;
+  }
+  _humRing.resize(max(1, (int) round(parameter("humWindow").toReal() * humRate)));
+  _humInterval = max(1, (int) round(parameter("humInterval").toReal() * _sampleRate));
+  _cpuDecay = exp(-_hopSize / (parameter("cpuWindow").toReal() * _sampleRate));
+
+  typedef essentia::standard::AlgorithmFactory Factory;
+  destroy();
+  _detectors[CLICK].algorithm = Factory::create("ClickDetector",
+                                                "sampleRate", _sampleRate,
+                                                "frameSize", frameSize,
+                                                "hopSize", _hopSize);
+  _detectors[DISCONTINUITY].algorithm = Factory::create("DiscontinuityDetector",
+                                                        "frameSize", frameSize,
+                                                        "hopSize", _hopSize);
+  _detectors[SATURATION].algorithm = Factory::create("SaturationDetector",
+                                                     "sampleRate", _sampleRate,
+                                                     "frameSize", frameSize,
+                                                     "hopSize", _hopSize);
+  _detectors[GAPS].algorithm = Factory::create("GapsDetector",
+                                               "sampleRate", _sampleRate,
+                                               "frameSize", frameSize,
+                                               "hopSize", _hopSize);
+  _detectors[NOISE_BURST].algorithm = Factory::create("NoiseBurstDetector");
+  _detectors[TRUE_PEAK].algorithm = Factory::create("TruePeakDetector",
+                                                    "sampleRate", _sampleRate);
+  _detectors[HUM].algorithm = Factory::create("HumDetector",
+                                              "sampleRate", humRate);
+
+  const Real threshold = _detectors[TRUE_PEAK].algorithm->parameter("threshold").toReal();
+  _truePeakGate = pow(10.0, (threshold - parameter("truePeakMargin").toReal()) / 20);
+
+  _detectors[CLICK].algorithm->output("starts").set(_starts);
+  _detectors[CLICK].algorithm->output("ends").set(_ends);
+  _detectors[DISCONTINUITY].algorithm->output("discontinuityLocations").set(_locations);
+  _detectors[DISCONTINUITY].algorithm->output("discontinuityAmplitudes").set(_amplitudes);
+  _detectors[SATURATION].algorithm->output("starts").set(_starts);
+  _detectors[SATURATION].algorithm->output("ends").set(_ends);
+  _detectors[GAPS].algorithm->output("starts").set(_starts);
+  _detectors[GAPS].algorithm->output("ends").set(_ends);
+  _detectors[NOISE_BURST].algorithm->output("indexes").set(_indexes);
+  _detectors[TRUE_PEAK].algorithm->output("peakLocations").set(_peaks);
+  _detectors[TRUE_PEAK].algorithm->output("output").set(_oversampled);
+  _detectors[HUM].algorithm->input("signal").set(_humSignal);
+  _detectors[HUM].algorithm->output("r").set(_humR);
+  _detectors[HUM].algorithm->output("frequencies").set(_humFrequencies);
+  _detectors[HUM].algorithm->output("saliences").set(_humSaliences);
+  _detectors[HUM].algorithm->output("starts").set(_humStarts);
+  _detectors[HUM].algorithm->output("ends").set(_humEnds);
+
+  clear();
+}
+
+void MLTKQCMonitor::clear(){
+  MLTKStatefulAlgorithm::clear();
+  for(Detector &d : _detectors){
+    d.running = false;
+    d.reported = false;
+    d.busy = 0;
+    d.load = 0;
+  }
+  _heard = false;
+  _truePeakCountdown = 0;
+  _humFilled = 0;
+  _humNext = 0;
+  _humCountdown = _humInterval;
+  _humPhase = 0;
+  fill(&_humState[0][0], &_humState[0][0] + 4, 0.0);
+}
+
+void MLTKQCMonitor::skipFrames(int count){
+  MLTKStatefulAlgorithm::clear();
+  const Real decay = pow(_cpuDecay, count);
+  for(Detector &d : _detectors){
+    d.running = false;
+    d.busy = 0;
+    d.load *= decay;
+  }
+
+  _truePeakCountdown = 0;
+
+  // HumDetector's window goes on filling, with silence
+  const long long samples = (long long) count * _hopSize;
+  const long long decimated = (samples + _humPhase) / _humFactor;
+  const int length = _humRing.size();
+  for(long long i = 0; i < min(decimated, (long long) length); i++){
+    _humRing[_humNext] = 0;
+    _humNext = (_humNext + 1) % length;
+  }
+  _humFilled = (int) min((long long) length, _humFilled + decimated);
+  _humPhase = (int) ((samples + _humPhase) % _humFactor);
+  fill(&_humState[0][0], &_humState[0][0] + 4, 0.0);
+  _humCountdown -= (int) (samples % _humInterval);
+  if(_humCountdown <= 0) _humCountdown += _humInterval;
+}
+
+void MLTKQCMonitor::start(Detector &d){
+  if(d.running) return;
+  d.algorithm->reset();
+  d.origin = _frameStart;
+  d.running = true;
+}
+
+unsigned long long MLTKQCMonitor::position(unsigned long long origin, Real seconds) const {
+  return origin + (unsigned long long) max((long long) 0, llround(seconds * _sampleRate));
+}
+
+void MLTKQCMonitor::report(Detector &d, unsigned long long start, unsigned long long end, Real value){
+  if(d.reported && start <= d.last + _minInterval){
+    d.last = max(d.last, end);
+    return;
+  }
+  emit(d.type, start, value);
+  d.reported = true;
+  d.last = end;
+}
+
+void MLTKQCMonitor::pushHum(const Real *samples, int count){
+  const int length = _humRing.size();
+  for(int i = 0; i < count; i++){
+    double x = samples[i];
+    for(int b = 0; b < 2; b++){
+      const double *c = _humCoefficients[b];
+      double *z = _humState[b];
+      const double y = c[0] * x + z[0];
+      z[0] = c[1] * x - c[3] * y + z[1];
+      z[1] = c[2] * x - c[4] * y;
+      x = y;
+    }
+    if(++_humPhase < _humFactor) continue;
+    _humPhase = 0;
+    _humRing[_humNext] = (Real) x;
+    _humNext = (_humNext + 1) % length;
+    if(_humFilled < length) _humFilled++;
+  }
+  _humCountdown -= count;
+}
+
+void MLTKQCMonitor::runHum(unsigned long long end){
+  const int length = _humRing.size();
+  _humSignal.resize(length);
+  copy(_humRing.begin() + _humNext, _humRing.end(), _humSignal.begin());
+  copy(_humRing.begin(), _humRing.begin() + _humNext, _humSignal.begin() + (length - _humNext));
+
+  Detector &d = _detectors[HUM];
+  d.algorithm->compute();
+
+  // the window ends with the newest sample of the frame
+  const unsigned long long span = (unsigned long long) length * _humFactor;
+  const unsigned long long origin = end > span ? end - span : 0;
+  for(int i = 0; i < (int) _humFrequencies.size() && i < (int) _humStarts.size(); i++){
+    report(d, position(origin, _humStarts[i]), position(origin, _humEnds[i]), _humFrequencies[i]);
+  }
+}
+
+AlgorithmStatus MLTKQCMonitor::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  const vector<Real> &frame = _frame.firstToken();
+  int count;
+  const Real *samples = newSamples(frame, count);
+
+  Real power = 0, peak = 0;
+  for(Real x : frame){
+    power += x * x;
+    peak = max(peak, (Real) fabs(x));
+  }
+  power /= max(1, (int) frame.size());
+  if(10 * log10(power + 1e-20) >= _silenceThreshold){
+    _heard = true;
+    _lastSound = _frameStart;
+  }
+  const bool active = _heard && _frameStart <= _lastSound + _silenceHold;
+
+  for(int i = 0; i < HUM; i++){
+    Detector &d = _detectors[i];
+    if(!active && i != GAPS){
+      d.running = false;
+      continue;
+    }
+    if(i == TRUE_PEAK){
+      if(--_truePeakCountdown > 0) continue;
+      _truePeakCountdown = _truePeakHops;
+      if(peak < _truePeakGate) continue;
+    }
+    start(d);
+    const double begin = threadCPUTime();
+    d.algorithm->input(i == TRUE_PEAK ? "signal" : "frame").set(frame);
+    d.algorithm->compute();
+
+    switch(i){
+      case CLICK:
+      case SATURATION:
+      case GAPS:
+        for(int k = 0; k < (int) _starts.size() && k < (int) _ends.size(); k++){
+          report(d, position(d.origin, _starts[k]), position(d.origin, _ends[k]), _ends[k] - _starts[k]);
+        }
+        break;
+      case DISCONTINUITY:
+        for(int k = 0; k < (int) _locations.size(); k++){
+          const unsigned long long sample = _frameStart + (unsigned long long) _locations[k];
+          report(d, sample, sample, k < (int) _amplitudes.size() ? _amplitudes[k] : 0);
+        }
+        break;
+      case NOISE_BURST:
+        for(Real index : _indexes){
+          const unsigned long long sample = _frameStart + (unsigned long long) index;
+          report(d, sample, sample, 0);
+        }
+        break;
+      case TRUE_PEAK:
+        if(_peaks.size() > 0){
+          Real peak = 0;
+          for(Real x : _oversampled) peak = max(peak, fabs(x));
+          const Real level = 20 * log10(peak + 1e-20);
+          for(Real index : _peaks){
+            const unsigned long long sample = _frameStart + (unsigned long long) index;
+            report(d, sample, sample, level);
+          }
+        }
+        break;
+    }
+    d.busy += threadCPUTime() - begin;
+  }
+
+  // the ring keeps filling through silence, HumDetector just doesn't run
+  pushHum(samples, count);
+  if(_humCountdown <= 0){
+    _humCountdown += _humInterval;
+    Detector &d = _detectors[HUM];
+    if(active && _humFilled == (int) _humRing.size()){
+      const double begin = threadCPUTime();
+      runHum(_frameStart + frame.size());
+      d.busy += threadCPUTime() - begin;
+    }
+  }
+
+  vector<Real> &cpu = _cpu.firstToken();
+  cpu.resize(DETECTORS);
+  const double hop = _hopSize / _sampleRate;
+  for(int i = 0; i < DETECTORS; i++){
+    Detector &d = _detectors[i];
+    d.load = _cpuDecay * d.load + (1 - _cpuDecay) * (Real) (d.busy / hop);
+    d.busy = 0;
+    cpu[i] = d.load;
+  }
+  _active.firstToken() = active ? 1 : 0;
+
+  releaseData();
+  return OK;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef MLTKQCMonitor_h
+#define MLTKQCMonitor_h
+
+#pragma once
+
+#include <vector>
+
+#include "algorithm.h"
+#include "utils/tnt/tnt.h"
+
+#include "MLTKStatefulAlgorithm.h"
+
+// Continuous audio problems monitor over the FrameCutter frames of the main
+// chain. It runs Essentia's ClickDetector, DiscontinuityDetector,
+// SaturationDetector, GapsDetector, NoiseBurstDetector, TruePeakDetector
+// and HumDetector and posts what they find as events with the incident's
+// sample position: "click", "discontinuity", "saturation", "gap",
+// "noiseBurst", "truePeak" and "hum" (value: duration [s], amplitude,
+// duration [s], duration [s], 0, true peak [dBTP] and frequency [Hz]).
+// Incidents of one kind closer than minInterval to the previous one are
+// merged into it, so a burst of clicks or a steady hum is posted once.
+//
+// Frames quieter than silenceThreshold for longer than silenceHold skip
+// every detector but GapsDetector, which is the one looking for silence.
+// A detector that skipped frames is reset before it runs again, so the
+// times it reports are counted from the frame it restarted on.
+//
+// TruePeakDetector oversamples its input, the most expensive per frame
+// detector. It runs on every frameSize/hopSize-th frame only, so each
+// sample is looked at once, and only when the frame's sample peak is
+// within truePeakMargin of its threshold: the true peak of a signal
+// rarely exceeds the sample peak by more than 3 dB.
+// HumDetector needs several seconds of signal and runs every humInterval
+// over the last humWindow seconds instead of on every frame. The hum is
+// below 400 Hz, so that window is kept low-passed and decimated to about
+// 4 kHz, which makes both the copy and HumDetector's analysis an order of
+// magnitude cheaper than at the input rate.
+//
+// The thread CPU time spent in each detector is output every hop as its
+// share of one core, averaged over cpuWindow seconds, in the order above.
+class MLTKQCMonitor : public MLTKStatefulAlgorithm {
+ protected:
+  Sink<vector<Real> > _frame;
+  Source<vector<Real> > _cpu;
+  Source<Real> _active;
+
+  enum { CLICK, DISCONTINUITY, SATURATION, GAPS, NOISE_BURST, TRUE_PEAK, HUM, DETECTORS };
+
+  struct Detector {
+    const char *type;
+    essentia::standard::Algorithm *algorithm;
+    bool running;               // saw the previous frame, its clock holds
+    unsigned long long origin;  // the frame it was last reset on
+    bool reported;
+    unsigned long long last;    // end of the last incident posted
+    double busy;                // seconds spent this hop
+    Real load;
+  };
+  Detector _detectors[DETECTORS];
+
+  Real _silenceThreshold;
+  int _silenceHold, _minInterval;
+  bool _heard;
+  unsigned long long _lastSound;
+
+  // TruePeakDetector runs every _truePeakHops frames, when the sample peak
+  // reaches _truePeakGate
+  int _truePeakHops, _truePeakCountdown;
+  Real _truePeakGate;
+
+  // the last humWindow seconds of audio decimated by _humFactor (a ring)
+  // and a straight copy of it
+  vector<Real> _humRing, _humSignal;
+  int _humFilled, _humNext, _humInterval, _humCountdown;
+
+  // the anti-aliasing low-pass in front of the decimation, two biquads
+  int _humFactor, _humPhase;
+  double _humCoefficients[2][5], _humState[2][2];
+
+  Real _cpuDecay;
+
+  // bound to the detectors' outputs
+  vector<Real> _starts, _ends, _locations, _amplitudes, _indexes, _peaks, _oversampled;
+  vector<Real> _humFrequencies, _humSaliences, _humStarts, _humEnds;
+  TNT::Array2D<Real> _humR;
+
+  void destroy();
+  void start(Detector &d);
+  void report(Detector &d, unsigned long long start, unsigned long long end, Real value);
+  unsigned long long position(unsigned long long origin, Real seconds) const;
+  void pushHum(const Real *samples, int count);
+  void runHum(unsigned long long end);
+
+ public:
+  MLTKQCMonitor();
+  ~MLTKQCMonitor();
+
+  void declareParameters() {
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
+    declareParameter("frameSize", "the size of the input frames", "[1,inf)", 2048);
+    declareParameter("hopSize", "the number of samples between consecutive frames", "[1,inf)", 1024);
+    declareParameter("silenceThreshold", "frames below this level count as silent [dB]", "(-inf,0]", -70.);
+    declareParameter("silenceHold", "how long the input has to stay silent before the detectors pause [s]", "[0,inf)", 0.5);
+    declareParameter("minInterval", "incidents of one kind closer than this are merged [s]", "[0,inf)", 0.05);
+    declareParameter("truePeakMargin", "TruePeakDetector only runs on frames whose sample peak is this close to its threshold [dB]", "[0,inf)", 3.);
+    declareParameter("humWindow", "the length of audio HumDetector looks at [s]", "(0,inf)", 20.);
+    declareParameter("humInterval", "the time between two HumDetector runs [s]", "(0,inf)", 5.);
+    declareParameter("cpuWindow", "the time the CPU loads are averaged over [s]", "(0,inf)", 10.);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+  void clear();
+  void skipFrames(int count);
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKQCMonitor_h */
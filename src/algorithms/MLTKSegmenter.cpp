@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#include "MLTKSegmenter.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* MLTKSegmenter::name = "MLTKSegmenter";
+const char* MLTKSegmenter::category = "Segmentation";
+const char* MLTKSegmenter::description = "This algorithm detects structural boundaries live, from a banded self-similarity matrix of MFCC and chroma blocks kept incrementally and a checkerboard kernel novelty. Boundaries are posted as events after a fixed delay.";
+
+MLTKSegmenter::MLTKSegmenter() :
+  _blockHops(1), _kernelSize(16), _peakWindow(8), _frameOffset(0), _delta(0.05), _hops(0),
+  _mean(0), _blocks(0), _origin(0), _noveltyValue(0) {
+  setName(name);
+  declareInput(_mfcc, 1, "mfcc", "the mfcc coefficients of the frame");
+  declareInput(_chroma, 1, "chroma", "the chroma or hpcp of the frame");
+  declareOutput(_novelty, 1, "novelty", "the latest novelty, kernelSize blocks behind");
+  declareOutput(_boundary, 1, "boundary", "1 when a boundary was posted during this hop, 0 otherwise");
+  declareParameters();
+}
+
+void MLTKSegmenter::configure(){
+  _sampleRate = parameter("sampleRate").toReal();
+  _hopSize = parameter("hopSize").toInt();
+  _frameOffset = parameter("frameSize").toInt() / 2.0;
+  _blockHops = max(1, (int) round(parameter("blockLength").toReal() * _sampleRate / _hopSize));
+  _kernelSize = parameter("kernelSize").toInt();
+  _peakWindow = parameter("peakWindow").toInt();
+  _delta = parameter("delta").toReal();
+
+  // checkerboard: + within the blocks before or after the boundary, -
+  // across it, tapered by a gaussian and scaled to a sum of magnitudes of 1
+  const int width = 2 * _kernelSize;
+  _kernel.resize(width * width);
+  const double sigma = 0.5 * _kernelSize;
+  double sum = 0;
+  for(int i = 0; i < width; i++){
+    for(int j = 0; j < width; j++){
+      const double u = i - _kernelSize + 0.5, v = j - _kernelSize + 0.5;
+      const double k = (u * v > 0 ? 1 : -1) * exp(-(u * u + v * v) / (2 * sigma * sigma));
+      _kernel[i * width + j] = k;
+      sum += fabs(k);
+    }
+  }
+  for(Real &k : _kernel) k /= sum;
+
+  _features.resize(width);
+  _rows.assign(width, vector<Real>(width));
+  _curve.resize(2 * _peakWindow + 1);
+  clear();
+}
+
+void MLTKSegmenter::clear(){
+  MLTKStatefulAlgorithm::clear();
+  _mfccSum.clear();
+  _chromaSum.clear();
+  _hops = 0;
+  fill(_curve.begin(), _curve.end(), 0);
+  _mean = 0;
+  _blocks = 0;
+  _noveltyValue = 0;
+}
+
+void MLTKSegmenter::skipFrames(int count){
+  if(_blocks == 0){
+    clear();
+    return;
+  }
+  MLTKStatefulAlgorithm::clear();
+
+  // the input was silent for a while before the gap, so the block being
+  // averaged, or else the last one, stands for the hops skipped
+  if(_hops == 0){
+    const vector<Real> &last = _features[(_blocks - 1) % (2 * _kernelSize)];
+    if(last.size() != _mfccSum.size() + _chromaSum.size()){
+      clear();
+      return;
+    }
+    copy(last.begin(), last.begin() + _mfccSum.size(), _mfccSum.begin());
+    copy(last.begin() + _mfccSum.size(), last.end(), _chromaSum.begin());
+  }
+
+  // past this many blocks the band and the novelty curve hold nothing but
+  // the gap, the ones before only move the clock
+  const long long hops = _hops + (long long) count;
+  long long blocks = hops / _blockHops;
+  _hops = hops % _blockHops;
+  const long long steady = 2 * _kernelSize + _curve.size();
+  if(blocks > steady){
+    _blocks += blocks - steady;
+    blocks = steady;
+  }
+  for(long long b = 0; b < blocks; b++) addBlock();
+}
+
+Real MLTKSegmenter::similarity(long long a, long long b) const {
+  const int width = 2 * _kernelSize;
+  if(a < b) swap(a, b);
+  return _rows[a % width][a - b];
+}
+
+bool MLTKSegmenter::addBlock(){
+  const int width = 2 * _kernelSize;
+  const long long t = _blocks++;
+
+  // the block's features, both halves at unit norm
+  vector<Real> &feature = _features[t % width];
+  feature.resize(_mfccSum.size() + _chromaSum.size());
+  double mfccNorm = 0, chromaNorm = 0;
+  for(size_t i = 1; i < _mfccSum.size(); i++) mfccNorm += _mfccSum[i] * _mfccSum[i];
+  for(size_t i = 0; i < _chromaSum.size(); i++) chromaNorm += _chromaSum[i] * _chromaSum[i];
+  mfccNorm = mfccNorm > 0 ? 1 / sqrt(2 * mfccNorm) : 0;
+  chromaNorm = chromaNorm > 0 ? 1 / sqrt(2 * chromaNorm) : 0;
+  feature[0] = 0;
+  for(size_t i = 1; i < _mfccSum.size(); i++) feature[i] = _mfccSum[i] * mfccNorm;
+  for(size_t i = 0; i < _chromaSum.size(); i++) feature[_mfccSum.size() + i] = _chromaSum[i] * chromaNorm;
+
+  // its row of the band
+  vector<Real> &row = _rows[t % width];
+  for(int k = 0; k < width && k <= t; k++){
+    const vector<Real> &other = _features[(t - k) % width];
+    Real s = 0;
+    if(other.size() == feature.size()){
+      for(size_t i = 0; i < feature.size(); i++) s += feature[i] * other[i];
+    }
+    row[k] = s;
+  }
+
+  // the novelty of the boundary before block c, once the kernel is full
+  const long long c = t - _kernelSize + 1;
+  if(c < _kernelSize) return false;
+  Real novelty = 0;
+  for(int i = 0; i < width; i++){
+    for(int j = 0; j < width; j++){
+      novelty += _kernel[i * width + j] * similarity(c - _kernelSize + i, c - _kernelSize + j);
+    }
+  }
+  _noveltyValue = novelty;
+
+  const int length = _curve.size();
+  const long long n = c - _kernelSize;
+  _curve[n % length] = novelty;
+  if(n + 1 < length) return false;
+
+  // the middle of the curve is a boundary if it's its largest value and
+  // stands out from the average
+  const long long candidate = n - _peakWindow;
+  const Real value = _curve[candidate % length];
+  bool peak = value > _mean + _delta;
+  for(int k = 0; k < length && peak; k++){
+    const long long m = n - k;
+    if(m != candidate && _curve[m % length] >= value) peak = false;
+  }
+
+  // the average over a few kernels, updated after the test
+  const double decay = exp(-1.0 / (4 * _kernelSize));
+  _mean = decay * _mean + (1 - decay) * _curve[candidate % length];
+
+  if(!peak) return false;
+  const long long block = candidate + _kernelSize;
+  emit("boundary", _origin + (unsigned long long) block * _blockHops * _hopSize + (unsigned long long) _frameOffset, value);
+  return true;
+}
+
+AlgorithmStatus MLTKSegmenter::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  nextFrame();
+  if(_hops == 0 && _blocks == 0) _origin = _frameStart;
+
+  const vector<Real> &mfcc = _mfcc.firstToken();
+  const vector<Real> &chroma = _chroma.firstToken();
+  if(_hops == 0){
+    _mfccSum.assign(mfcc.size(), 0);
+    _chromaSum.assign(chroma.size(), 0);
+  }
+  if(mfcc.size() == _mfccSum.size() && chroma.size() == _chromaSum.size()){
+    for(size_t i = 0; i < mfcc.size(); i++) _mfccSum[i] += mfcc[i];
+    for(size_t i = 0; i < chroma.size(); i++) _chromaSum[i] += chroma[i];
+  }
+
+  Real boundary = 0;
+  if(++_hops == _blockHops){
+    _hops = 0;
+    if(addBlock()) boundary = 1;
+  }
+
+  _novelty.firstToken() = _noveltyValue;
+  _boundary.firstToken() = boundary;
+  releaseData();
+  return OK;
+}
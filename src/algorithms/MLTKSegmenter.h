@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#ifndef MLTKSegmenter_h
+#define MLTKSegmenter_h
+
+#pragma once
+
+#include <vector>
+
+#include "MLTKStatefulAlgorithm.h"
+
+// Live structural segmentation (Foote's novelty) from MFCC and chroma
+// streams, in memory that depends on the analysis window only.
+//
+// The frames are averaged into blocks of blockLength seconds, and each
+// block's MFCC (without the energy coefficient) and chroma are scaled to
+// unit norm side by side. Every new block adds one row to a banded
+// self-similarity matrix: its cosine similarity with the 2 * kernelSize - 1
+// blocks before it, kept in a ring. The novelty of the boundary kernelSize
+// blocks back is then the correlation of the band with a gaussian tapered
+// checkerboard kernel.
+//
+// A boundary is a novelty peak that is the largest within peakWindow blocks
+// on either side and rises delta above the average novelty of the last
+// few kernels. It is posted as a "boundary" event (value: novelty) at the
+// start of its block, kernelSize + peakWindow blocks after that (12 s with
+// the defaults).
+class MLTKSegmenter : public MLTKStatefulAlgorithm {
+ protected:
+  Sink<vector<Real> > _mfcc;
+  Sink<vector<Real> > _chroma;
+  Source<Real> _novelty;
+  Source<Real> _boundary;
+
+  int _blockHops, _kernelSize, _peakWindow;
+  Real _frameOffset, _delta;
+
+  // the block being averaged
+  vector<Real> _mfccSum, _chromaSum;
+  int _hops;
+
+  // the last 2 * kernelSize blocks' features and similarity rows (rings),
+  // row t holds the similarity of block t with blocks t, t-1, ...
+  vector<vector<Real> > _features, _rows;
+  vector<Real> _kernel;
+
+  // the novelty of the last blocks (a ring) and its running average
+  vector<Real> _curve;
+  double _mean;
+
+  // blocks since clear() and the stream position of the first one
+  long long _blocks;
+  unsigned long long _origin;
+  Real _noveltyValue;
+
+  Real similarity(long long a, long long b) const;
+  bool addBlock();
+
+ public:
+  MLTKSegmenter();
+
+  void declareParameters() {
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
+    declareParameter("frameSize", "the frame size the features were computed on, its center is taken as the frame's time", "[1,inf)", 2048);
+    declareParameter("hopSize", "the number of samples between consecutive feature frames", "[1,inf)", 1024);
+    declareParameter("blockLength", "the length of the blocks the features are averaged over [s]", "(0,inf)", 0.5);
+    declareParameter("kernelSize", "the number of blocks on each side of a boundary the kernel compares", "[2,inf)", 16);
+    declareParameter("peakWindow", "the number of blocks on either side a boundary has to be the largest novelty of", "[1,inf)", 8);
+    declareParameter("delta", "how far a boundary's novelty has to rise above the average", "[0,inf)", 0.05);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+  void clear();
+  void skipFrames(int count);
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKSegmenter_h */
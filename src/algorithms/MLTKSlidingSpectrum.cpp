@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "MLTKSlidingSpectrum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+const char* MLTKSlidingSpectrum::name = "MLTKSlidingSpectrum";
+const char* MLTKSlidingSpectrum::category = "Spectral";
+const char* MLTKSlidingSpectrum::description = "This algorithm computes the windowed magnitude spectrum of a sliding frame incrementally, updating the previous spectrum with the DFT of the samples each hop changed and applying the window in the frequency domain. It can track only a selection of bins.";
+
+MLTKSlidingSpectrum::MLTKSlidingSpectrum() :
+  _size(0), _a0(0.5), _a1(0.5), _scale(1), _position(0), _sinceSync(0), _computePhase(false),
+  _in(0), _out(0), _blockSize(0), _blockIn(0), _blockOut(0) {
+  setName(name);
+  declareInput(_frame, 1, "frame", "the input audio frame, consecutive frames are one hop apart");
+  declareOutput(_spectrum, 1, "spectrum", "the magnitude spectrum of the windowed frame, or of the requested bins");
+  declareOutput(_phase, 1, "phase", "the phase spectrum of the zero-phase windowed frame like CartesianToPolar's, empty unless computePhase is set");
+  declareParameters();
+}
+
+MLTKSlidingSpectrum::~MLTKSlidingSpectrum(){
+  MLTKFFT::free(_in);
+  MLTKFFT::free(_out);
+  MLTKFFT::free(_blockIn);
+  MLTKFFT::free(_blockOut);
+}
+
+void MLTKSlidingSpectrum::configure(){
+  _hopSize = parameter("hopSize").toInt();
+
+  // generalized cosine windows: a0 - a1 cos(2 pi n / N) is a0 on the bin
+  // minus a1/2 on each neighbour
+  const string type = parameter("type").toString();
+  if(type == "hann") _a0 = 0.5;
+  else if(type == "hamming") _a0 = 0.53836;
+  else _a0 = 1;
+  _a1 = 1 - _a0;
+
+  _requested.clear();
+  for(Real b : parameter("bins").toVectorReal()) _requested.push_back((int) b);
+  _computePhase = parameter("computePhase").toBool();
+
+  _size = 0;
+  setSize(parameter("size").toInt());
+}
+
+void MLTKSlidingSpectrum::setSize(int size){
+  if(size == _size) return;
+  _size = size;
+  const int half = size / 2;
+
+  // normalized like Windowing, to a sum of 2
+  _scale = parameter("normalized").toBool() ? 2.0 / (_a0 * size) : 1.0;
+
+  vector<int> outputs = _requested;
+  if(outputs.empty()){
+    for(int k = 0; k <= half; k++) outputs.push_back(k);
+  }
+
+  // every output bin needs itself and, windowed, both neighbours. Bins
+  // outside [0, N/2] are the conjugates of mirrored ones.
+  map<int, int> tracked;
+  auto track = [&](int k) {
+    if(tracked.count(k) == 0){
+      int index = tracked.size();
+      tracked[k] = index;
+    }
+    return tracked[k];
+  };
+  _center.clear(); _below.clear(); _above.clear();
+  _belowMirrored.clear(); _aboveMirrored.clear();
+  for(int k : outputs){
+    if(k < 0 || k > half){
+      throw EssentiaException("MLTKSlidingSpectrum: bin ", k, " is outside of the spectrum");
+    }
+    _center.push_back(track(k));
+    if(_a1 != 0){
+      _belowMirrored.push_back(k == 0);
+      _below.push_back(track(k == 0 ? 1 : k - 1));
+      _aboveMirrored.push_back(k == half);
+      _above.push_back(track(k == half ? half - 1 : k + 1));
+    }
+  }
+
+  _bins.assign(tracked.size(), 0);
+  for(auto &t : tracked) _bins[t.second] = t.first;
+  _rotationRe.resize(_bins.size());
+  _rotationIm.resize(_bins.size());
+  for(size_t i = 0; i < _bins.size(); i++){
+    _rotationRe[i] = cos(2 * M_PI * _bins[i] / size);
+    _rotationIm[i] = sin(2 * M_PI * _bins[i] / size);
+  }
+  _re.resize(_bins.size());
+  _im.resize(_bins.size());
+  _ring.resize(size);
+
+  _rootRe.resize(size);
+  _rootIm.resize(size);
+  for(int n = 0; n < size; n++){
+    _rootRe[n] = cos(2 * M_PI * n / size);
+    _rootIm[n] = sin(2 * M_PI * n / size);
+  }
+  _deltaRe.resize(half + 1);
+  _deltaIm.resize(half + 1);
+  _blockSize = 0;
+
+  _plan = MLTKFFT::plan(size, MLTKFFT::REAL_FORWARD);
+  MLTKFFT::free(_in);
+  MLTKFFT::free(_out);
+  _in = MLTKFFT::allocReal(size);
+  _out = MLTKFFT::allocComplex(half + 1);
+
+  clear();
+}
+
+void MLTKSlidingSpectrum::clear(){
+  MLTKStatefulAlgorithm::clear();
+  fill(_ring.begin(), _ring.end(), 0);
+  fill(_re.begin(), _re.end(), 0);
+  fill(_im.begin(), _im.end(), 0);
+  _position = 0;
+  _sinceSync = 0;
+}
+
+void MLTKSlidingSpectrum::synchronize(){
+  // the sums are the DFT of the ring, oldest sample first
+  for(int n = 0; n < _size; n++){
+    _in[n] = _ring[(_position + n) % _size];
+  }
+  _plan->execute(_in, _out);
+  for(size_t i = 0; i < _bins.size(); i++){
+    _re[i] = _out[_bins[i]][0];
+    _im[i] = _out[_bins[i]][1];
+  }
+  _sinceSync = 0;
+}
+
+void MLTKSlidingSpectrum::setBlockSize(int size){
+  if(size == _blockSize) return;
+  _blockSize = size;
+
+  _blockPlan = MLTKFFT::plan(size, MLTKFFT::COMPLEX_FORWARD);
+  MLTKFFT::free(_blockIn);
+  MLTKFFT::free(_blockOut);
+  _blockIn = MLTKFFT::allocComplex(size);
+  _blockOut = MLTKFFT::allocComplex(size);
+  for(int n = 0; n < size; n++){
+    _blockIn[n][0] = _blockIn[n][1] = 0;
+  }
+}
+
+// One sample at a time, S_k <- (S_k + new - oldest) * e^(2 pi i k / N)
+void MLTKSlidingSpectrum::slideSamples(const Real *x, int count){
+  const int tracked = _bins.size();
+  double *re = &_re[0], *im = &_im[0];
+  const double *c = &_rotationRe[0], *s = &_rotationIm[0];
+  for(int n = 0; n < count; n++){
+    const double delta = x[n] - _ring[_position];
+    _ring[_position] = x[n];
+    _position = (_position + 1) % _size;
+
+    for(int i = 0; i < tracked; i++){
+      const double r = re[i] + delta;
+      re[i] = r * c[i] - im[i] * s[i];
+      im[i] = r * s[i] + im[i] * c[i];
+    }
+  }
+}
+
+// The whole hop at once: S_k <- (S_k + D_k) * e^(2 pi i k count / N), where
+// D is the DFT of the count differences d[n] = new - oldest. With k = r + M s
+// (M = N/L), D_k = sum_n (d[n] e^(-2 pi i r n / N)) e^(-2 pi i s n / L), an
+// L point FFT per residue r. d is real, so D_(N-k) is the conjugate of D_k
+// and residues above M/2 come from the ones below.
+void MLTKSlidingSpectrum::slideBlock(const Real *x, int count, int block){
+  setBlockSize(block);
+  const int half = _size / 2;
+  const int residues = _size / _blockSize;
+
+  _difference.resize(count);
+  for(int n = 0; n < count; n++){
+    _difference[n] = x[n] - _ring[_position];
+    _ring[_position] = x[n];
+    _position = (_position + 1) % _size;
+  }
+
+  for(int n = count; n < _blockSize; n++){
+    _blockIn[n][0] = _blockIn[n][1] = 0;
+  }
+
+  for(int r = 0; r <= residues / 2; r++){
+    for(int n = 0; n < count; n++){
+      const int root = (int) (((long long) r * n) % _size);
+      _blockIn[n][0] = _difference[n] * _rootRe[root];
+      _blockIn[n][1] = -_difference[n] * _rootIm[root];
+    }
+    _blockPlan->execute(_blockIn, _blockOut);
+
+    for(int s = 0; s < _blockSize; s++){
+      const int k = r + residues * s;
+      if(k <= half){
+        _deltaRe[k] = _blockOut[s][0];
+        _deltaIm[k] = _blockOut[s][1];
+      }
+      if(k > 0 && _size - k <= half){
+        _deltaRe[_size - k] = _blockOut[s][0];
+        _deltaIm[_size - k] = -_blockOut[s][1];
+      }
+    }
+  }
+
+  for(size_t i = 0; i < _bins.size(); i++){
+    const int k = _bins[i];
+    const int root = (int) (((long long) k * count) % _size);
+    const double re = _re[i] + _deltaRe[k], im = _im[i] + _deltaIm[k];
+    _re[i] = re * _rootRe[root] - im * _rootIm[root];
+    _im[i] = re * _rootIm[root] + im * _rootRe[root];
+  }
+}
+
+AlgorithmStatus MLTKSlidingSpectrum::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  const vector<Real> &frame = _frame.firstToken();
+  if((int) frame.size() < 4){
+    throw EssentiaException("MLTKSlidingSpectrum: the input frame is too short");
+  }
+  if((int) frame.size() != _size) setSize(frame.size());
+
+  int count;
+  const Real *x = newSamples(frame, count);
+
+  if(count >= _size){
+    copy(x + count - _size, x + count, _ring.begin());
+    _position = 0;
+    synchronize();
+  } else {
+    // the block size L is the smallest divisor of N that holds the hop, so
+    // the bins split evenly into N/L residues. The block update costs about
+    // N/2 (log2 L + 4), independent of the number of tracked bins.
+    int block = count;
+    while(_size % block != 0) block++;
+    const double blockCost = _size / 2.0 * (log2((double) block) + 4);
+    if((double) _bins.size() * count > blockCost){
+      slideBlock(x, count, block);
+    } else {
+      slideSamples(x, count);
+    }
+    _sinceSync += count;
+    if(_sinceSync >= _size) synchronize();
+  }
+
+  vector<Real> &spectrum = _spectrum.firstToken();
+  spectrum.resize(_center.size());
+  vector<Real> &phase = _phase.firstToken();
+  phase.resize(_computePhase ? _center.size() : 0);
+  for(size_t j = 0; j < _center.size(); j++){
+    double re = _a0 * _re[_center[j]];
+    double im = _a0 * _im[_center[j]];
+    if(_a1 != 0){
+      const int b = _below[j], a = _above[j];
+      re -= _a1 / 2 * (_re[b] + _re[a]);
+      im -= _a1 / 2 * ((_belowMirrored[j] ? -_im[b] : _im[b]) + (_aboveMirrored[j] ? -_im[a] : _im[a]));
+    }
+    spectrum[j] = _scale * sqrt(re * re + im * im);
+
+    // Windowing centres the frame on sample 0, which flips odd bins
+    if(_computePhase){
+      if(_bins[_center[j]] % 2 == 1){
+        re = -re;
+        im = -im;
+      }
+      phase[j] = atan2(im, re);
+    }
+  }
+
+  releaseData();
+  return OK;
+}
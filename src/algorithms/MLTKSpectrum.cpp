@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "MLTKSpectrum.h"
+
+#include <cmath>
+
+const char* MLTKSpectrum::name = "MLTKSpectrum";
+const char* MLTKSpectrum::category = "Spectral";
+const char* MLTKSpectrum::description = "This algorithm windows a frame and computes its magnitude, power and phase spectra in one pass. It is equivalent to Windowing followed by Spectrum, PowerSpectrum and FFT with CartesianToPolar, without the intermediate copies.";
+
+MLTKSpectrum::MLTKSpectrum() :
+  _size(0), _normalized(true), _zeroPhase(true), _computePhase(false),
+  _in(0), _out(0) {
+  setName(name);
+  declareInput(_frame, 1, "frame", "the input audio frame");
+  declareOutput(_windowed, 1, "frame", "the windowed audio frame");
+  declareOutput(_spectrum, 1, "spectrum", "the magnitude spectrum of the windowed frame");
+  declareOutput(_power, 1, "power", "the power spectrum of the windowed frame");
+  declareOutput(_phase, 1, "phase", "the phase spectrum of the windowed frame, empty unless computePhase is set");
+  declareParameters();
+}
+
+MLTKSpectrum::~MLTKSpectrum(){
+  MLTKFFT::free(_in);
+  MLTKFFT::free(_out);
+}
+
+void MLTKSpectrum::configure(){
+  _type = parameter("type").toString();
+  _normalized = parameter("normalized").toBool();
+  _zeroPhase = parameter("zeroPhase").toBool();
+  _computePhase = parameter("computePhase").toBool();
+
+  _size = 0;
+  setSize(parameter("size").toInt());
+}
+
+void MLTKSpectrum::setSize(int size){
+  if(size == _size) return;
+  _size = size;
+
+  _window = MLTKTables::window(_type, size, _normalized);
+  _plan = MLTKFFT::plan(size, MLTKFFT::REAL_FORWARD);
+
+  MLTKFFT::free(_in);
+  MLTKFFT::free(_out);
+  _in = MLTKFFT::allocReal(size);
+  _out = MLTKFFT::allocComplex(size / 2 + 1);
+}
+
+AlgorithmStatus MLTKSpectrum::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  const vector<Real> &frame = _frame.firstToken();
+  if(frame.empty()){
+    throw EssentiaException("MLTKSpectrum: the input frame is empty");
+  }
+  if((int) frame.size() != _size) setSize(frame.size());
+
+  const Real *w = &(*_window)[0];
+  const Real *x = &frame[0];
+
+  // window straight into the FFT input, with zero phase the second half
+  // of the frame goes first
+  const int half = _zeroPhase ? _size / 2 : 0;
+  for(int i = 0; i < _size - half; i++){
+    _in[i] = x[half + i] * w[half + i];
+  }
+  for(int i = 0; i < half; i++){
+    _in[_size - half + i] = x[i] * w[i];
+  }
+
+  _plan->execute(_in, _out);
+
+  const int bins = _size / 2 + 1;
+  const float *bin = (const float*) _out;
+
+  vector<Real> &windowed = _windowed.firstToken();
+  windowed.assign(_in, _in + _size);
+
+  // plain loops over interleaved re/im, the compiler vectorizes them
+  vector<Real> &power = _power.firstToken();
+  power.resize(bins);
+  Real *p = &power[0];
+  for(int k = 0; k < bins; k++){
+    const float re = bin[2 * k], im = bin[2 * k + 1];
+    p[k] = re * re + im * im;
+  }
+
+  vector<Real> &magnitude = _spectrum.firstToken();
+  magnitude.resize(bins);
+  Real *m = &magnitude[0];
+  for(int k = 0; k < bins; k++){
+    m[k] = sqrt(p[k]);
+  }
+
+  vector<Real> &phase = _phase.firstToken();
+  if(_computePhase){
+    phase.resize(bins);
+    for(int k = 0; k < bins; k++){
+      phase[k] = atan2(bin[2 * k + 1], bin[2 * k]);
+    }
+  } else {
+    phase.clear();
+  }
+
+  releaseData();
+  return OK;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef MLTKSpectrum_h
+#define MLTKSpectrum_h
+
+#pragma once
+
+#include <vector>
+
+#include "streaming/streamingalgorithm.h"
+
+#include "ofxMLTKFFT.h"
+#include "ofxMLTKTables.h"
+
+using namespace std;
+using namespace essentia;
+using namespace streaming;
+
+// Fused spectral front end: Windowing -> Spectrum (and FFT ->
+// CartesianToPolar) in one algorithm.
+//
+// The frame is windowed straight into an FFTW aligned buffer (rotated for
+// zero phase like Windowing does), transformed with a shared real-to-complex
+// plan and the magnitude, power and optionally phase spectra are computed
+// in one pass over the bins, without the intermediate tokens and copies of
+// the separate algorithms. The window comes from MLTKTables and the plan
+// from MLTKFFT, so every instance with the same size shares them.
+//
+// Outputs match Windowing ("frame"), Spectrum ("spectrum"), PowerSpectrum
+// ("power") and CartesianToPolar's phase ("phase") within float rounding.
+class MLTKSpectrum : public Algorithm {
+ protected:
+  Sink<vector<Real> > _frame;
+  Source<vector<Real> > _windowed;
+  Source<vector<Real> > _spectrum;
+  Source<vector<Real> > _power;
+  Source<vector<Real> > _phase;
+
+  int _size;
+  string _type;
+  bool _normalized, _zeroPhase, _computePhase;
+
+  MLTKTables::Handle _window;
+  MLTKFFT::Handle _plan;
+  float *_in;
+  fftwf_complex *_out;
+
+  void setSize(int size);
+
+ public:
+  MLTKSpectrum();
+  ~MLTKSpectrum();
+
+  void declareParameters() {
+    declareParameter("size", "the expected frame size, other sizes are adapted to on the fly", "[2,inf)", 1024);
+    declareParameter("type", "the window type", "{hann,hamming,triangular,square,blackmanharris62,blackmanharris70,blackmanharris74,blackmanharris92}", "hann");
+    declareParameter("normalized", "whether to normalize the window to a sum of 2, like Windowing", "{true,false}", true);
+    declareParameter("zeroPhase", "whether to rotate the windowed frame so its center is at 0, like Windowing", "{true,false}", true);
+    declareParameter("computePhase", "whether to compute the phase output, it is left empty otherwise", "{true,false}", false);
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKSpectrum_h */
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "MLTKStatefulAlgorithm.h"
+
+MLTKStatefulAlgorithm::MLTKStatefulAlgorithm() :
+  _hopSize(0), _sampleRate(44100), _cleared(true), _frameStart(0), _nextFrame(0), _events(0) {
+}
+
+void MLTKStatefulAlgorithm::clear(){
+  _cleared = true;
+}
+
+void MLTKStatefulAlgorithm::skipFrames(int /*count*/){
+  clear();
+}
+
+void MLTKStatefulAlgorithm::setPosition(unsigned long long sample){
+  _nextFrame = sample;
+}
+
+void MLTKStatefulAlgorithm::setEventQueue(MLTKEventQueue *events){
+  _events = events;
+}
+
+void MLTKStatefulAlgorithm::nextFrame(){
+  _frameStart = _nextFrame;
+  _nextFrame += _hopSize;
+}
+
+const Real* MLTKStatefulAlgorithm::newSamples(const vector<Real> &frame, int &count){
+  nextFrame();
+  count = frame.size();
+  if(!_cleared && _hopSize > 0 && _hopSize < count) count = _hopSize;
+  _cleared = false;
+  return count > 0 ? &frame[frame.size() - count] : 0;
+}
+
+void MLTKStatefulAlgorithm::emit(const char *type, unsigned long long sample, Real value){
+  if(_events == NULL) return;
+  MLTKEvent event;
+  event.type = type;
+  event.sample = sample;
+  event.time = (double) sample / _sampleRate;
+  event.value = value;
+  _events->push(event);
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef MLTKStatefulAlgorithm_h
+#define MLTKStatefulAlgorithm_h
+
+#pragma once
+
+#include <vector>
+
+#include "streaming/streamingalgorithm.h"
+
+#include "ofxMLTKEvents.h"
+
+using namespace std;
+using namespace essentia;
+using namespace streaming;
+
+// Base for MLTK's streaming algorithms that carry state from one hop to the
+// next (running transforms, trackers, meters) in the realtime network.
+//
+// MLTKCore resets its network before every run(), so these keep their state
+// through reset(), which only empties the connector buffers, and forget it
+// in clear() instead. Every input token is one hop later than the one
+// before. When the input is a FrameCutter frame only its newest hopSize
+// samples are new, so newSamples() hands out just those, and the whole
+// frame on the first call after clear().
+//
+// MLTKCore also tells them where the next frame starts in the input stream
+// (setPosition()) and where to post events (setEventQueue()), so events
+// carry sample positions on the stream's own clock. When its silence gate
+// skips hops it calls skipFrames() instead of running them.
+class MLTKStatefulAlgorithm : public Algorithm {
+ protected:
+  int _hopSize;
+  Real _sampleRate;
+  bool _cleared;
+
+  // absolute sample positions of the frame being processed and the next one
+  unsigned long long _frameStart, _nextFrame;
+
+  MLTKEventQueue *_events;
+
+  // Moves on to the next frame, once per input token
+  void nextFrame();
+
+  // Moves on to the next frame and returns the part of it not seen before,
+  // count is set to its length
+  const Real* newSamples(const vector<Real> &frame, int &count);
+
+  // Posts an event if there is a queue
+  void emit(const char *type, unsigned long long sample, Real value);
+
+ public:
+  MLTKStatefulAlgorithm();
+
+  // Forgets everything seen so far, e.g. after a gap in the audio.
+  // Subclasses clear their own state and call this.
+  virtual void clear();
+
+  // Brings the state forward over count hops of silent input that were not
+  // processed. By default it forgets everything, which is where silence
+  // leaves most of them; those that remember more than silence erases
+  // override it.
+  virtual void skipFrames(int count);
+
+  // Absolute sample position at which the next input frame starts
+  void setPosition(unsigned long long sample);
+
+  void setEventQueue(MLTKEventQueue *events);
+};
+
+#endif /* MLTKStatefulAlgorithm_h */
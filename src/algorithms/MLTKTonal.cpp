@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#include "MLTKTonal.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* MLTKTonal::name = "MLTKTonal";
+const char* MLTKTonal::category = "Tonal";
+const char* MLTKTonal::description = "This algorithm estimates the key and the current chord from a stream of HPCP frames, from a decaying and a windowed average profile, in constant time and memory per frame. Changes are posted as events.";
+
+static const char* pitchClasses[12] = { "A", "Bb", "B", "C", "C#", "D", "Eb", "E", "F", "F#", "G", "Ab" };
+
+MLTKTonal::MLTKTonal() :
+  _frameOffset(0), _decay(0), _length(1), _filled(0), _next(0),
+  _keyIndex(-1), _chordIndex(-1), _keyCorrelation(0), _chordCorrelation(0) {
+  setName(name);
+  declareInput(_hpcp, 1, "hpcp", "the hpcp, one per hop, starting on A");
+  declareOutput(_key, 1, "key", "the estimated key, empty until there was something to go by");
+  declareOutput(_scale, 1, "scale", "the scale of the key (major or minor)");
+  declareOutput(_keyStrength, 1, "keyStrength", "the correlation of the key profile with the key's template");
+  declareOutput(_chord, 1, "chord", "the current chord, e.g. A or Am");
+  declareOutput(_chordStrength, 1, "chordStrength", "the correlation of the chord profile with the chord's triad");
+  declareParameters();
+}
+
+void MLTKTonal::configure(){
+  _sampleRate = parameter("sampleRate").toReal();
+  _hopSize = parameter("hopSize").toInt();
+  _frameOffset = parameter("frameSize").toInt() / 2.0;
+  _decay = exp(-_hopSize / (parameter("keyMemory").toReal() * _sampleRate));
+  _length = max(1, (int) round(parameter("chordWindow").toReal() * _sampleRate / _hopSize));
+
+  _keyProfiles = MLTKTables::tonalProfiles(parameter("profileType").toString());
+  _chordProfiles = MLTKTables::tonalProfiles("triads");
+  _window.resize(_length * 12);
+  clear();
+}
+
+void MLTKTonal::clear(){
+  MLTKStatefulAlgorithm::clear();
+  for(int i = 0; i < 12; i++){
+    _profile[i] = 0;
+    _sum[i] = 0;
+  }
+  _filled = 0;
+  _next = 0;
+  _keyIndex = -1;
+  _chordIndex = -1;
+  _keyCorrelation = 0;
+  _chordCorrelation = 0;
+}
+
+void MLTKTonal::skipFrames(int count){
+  MLTKStatefulAlgorithm::clear();
+
+  // silent hops: the key profile decays and the chord window empties, the
+  // key and chord stay what they were
+  const double decay = pow((double) _decay, count);
+  for(int i = 0; i < 12; i++) _profile[i] *= decay;
+  if(count >= _length){
+    fill(_window.begin(), _window.end(), 0);
+    for(int i = 0; i < 12; i++) _sum[i] = 0;
+    _filled = _length;
+    return;
+  }
+  for(int k = 0; k < count; k++){
+    Real *slot = &_window[_next * 12];
+    for(int i = 0; i < 12; i++){
+      if(_filled == _length) _sum[i] -= slot[i];
+      slot[i] = 0;
+    }
+    if(_filled < _length) _filled++;
+    _next = (_next + 1) % _length;
+  }
+}
+
+int MLTKTonal::best(const MLTKTables::Table &profiles, const double *x, Real &correlation){
+  double mean = 0, norm = 0, centered[12];
+  for(int i = 0; i < 12; i++) mean += x[i] / 12;
+  for(int i = 0; i < 12; i++){
+    centered[i] = x[i] - mean;
+    norm += centered[i] * centered[i];
+  }
+  // a flat profile (silence) says nothing
+  if(norm < 1e-12) return -1;
+  norm = sqrt(norm);
+
+  int index = -1;
+  double strongest = -2;
+  for(int k = 0; k < 24; k++){
+    const Real *p = &profiles[k * 12];
+    double c = 0;
+    for(int i = 0; i < 12; i++) c += p[i] * centered[i];
+    if(c > strongest){
+      strongest = c;
+      index = k;
+    }
+  }
+  correlation = strongest / norm;
+  return index;
+}
+
+AlgorithmStatus MLTKTonal::process(){
+  AlgorithmStatus status = acquireData();
+  if(status != OK) return status;
+
+  nextFrame();
+  const vector<Real> &hpcp = _hpcp.firstToken();
+  const int size = hpcp.size();
+  if(size < 12 || size % 12 != 0){
+    throw EssentiaException("MLTKTonal: the hpcp size has to be a multiple of 12");
+  }
+
+  // fold onto the 12 pitch classes, a bin belongs to the nearest one
+  const int resolution = size / 12;
+  double classes[12] = { 0 };
+  for(int i = 0; i < size; i++){
+    classes[((i + resolution / 2) / resolution) % 12] += hpcp[i];
+  }
+
+  // the newest hop takes the oldest one's place in the ring and the sum
+  Real *slot = &_window[_next * 12];
+  for(int i = 0; i < 12; i++){
+    if(_filled == _length) _sum[i] -= slot[i];
+    slot[i] = classes[i];
+    _sum[i] += classes[i];
+    _profile[i] = _decay * _profile[i] + (1 - _decay) * classes[i];
+  }
+  if(_filled < _length) _filled++;
+  _next = (_next + 1) % _length;
+
+  // rebuilt once per lap, so rounding errors don't pile up
+  if(_next == 0){
+    for(int i = 0; i < 12; i++) _sum[i] = 0;
+    for(int j = 0; j < _filled; j++){
+      for(int i = 0; i < 12; i++) _sum[i] += _window[j * 12 + i];
+    }
+  }
+
+  const unsigned long long sample = _frameStart + (unsigned long long) _frameOffset;
+  Real correlation = 0;
+  const int key = best(*_keyProfiles, _profile, correlation);
+  if(key >= 0){
+    _keyCorrelation = correlation;
+    if(key != _keyIndex) emit("key", sample, key);
+    _keyIndex = key;
+  }
+  const int chord = best(*_chordProfiles, _sum, correlation);
+  if(chord >= 0){
+    _chordCorrelation = correlation;
+    if(chord != _chordIndex) emit("chord", sample, chord);
+    _chordIndex = chord;
+  }
+
+  if(_keyIndex >= 0){
+    _key.firstToken() = pitchClasses[_keyIndex % 12];
+    _scale.firstToken() = _keyIndex < 12 ? "major" : "minor";
+  } else {
+    _key.firstToken() = "";
+    _scale.firstToken() = "";
+  }
+  _keyStrength.firstToken() = _keyCorrelation;
+  if(_chordIndex >= 0){
+    _chord.firstToken() = string(pitchClasses[_chordIndex % 12]) + (_chordIndex < 12 ? "" : "m");
+  } else {
+    _chord.firstToken() = "";
+  }
+  _chordStrength.firstToken() = _chordCorrelation;
+  releaseData();
+  return OK;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+#ifndef MLTKTonal_h
+#define MLTKTonal_h
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "MLTKStatefulAlgorithm.h"
+#include "ofxMLTKTables.h"
+
+// Streaming key and chord estimation from a stream of HPCP frames, one per
+// hop, in fixed memory however long the performance runs.
+//
+// The key comes from an exponentially decaying average of the HPCP (time
+// constant keyMemory), the chord from a plain average over the last
+// chordWindow seconds kept as a ring with a running sum. Each hop both
+// profiles are correlated with the 24 major and minor templates from
+// MLTKTables::tonalProfiles(), key profiles for the key and tonic triads for
+// the chord, so an update costs a few hundred multiplications.
+//
+// HPCP with more than 12 bins (36, 120...) is folded onto the 12 pitch
+// classes first. Names and the first bin on A follow Essentia's Key. Every
+// change of key or chord is posted as a "key" or "chord" event whose value
+// is the template's index, 0-11 for A major to Ab major and 12-23 for A
+// minor to Ab minor.
+class MLTKTonal : public MLTKStatefulAlgorithm {
+ protected:
+  Sink<vector<Real> > _hpcp;
+  Source<string> _key;
+  Source<string> _scale;
+  Source<Real> _keyStrength;
+  Source<string> _chord;
+  Source<Real> _chordStrength;
+
+  MLTKTables::Handle _keyProfiles, _chordProfiles;
+  Real _frameOffset, _decay;
+
+  // the decaying profile, and the ring of the last hops' pitch classes with
+  // their running sum
+  double _profile[12];
+  vector<Real> _window;
+  double _sum[12];
+  int _length, _filled, _next;
+
+  int _keyIndex, _chordIndex;
+  Real _keyCorrelation, _chordCorrelation;
+
+  static int best(const MLTKTables::Table &profiles, const double *x, Real &correlation);
+
+ public:
+  MLTKTonal();
+
+  void declareParameters() {
+    declareParameter("sampleRate", "the sampling rate of the audio signal [Hz]", "(0,inf)", 44100.);
+    declareParameter("frameSize", "the frame size the hpcp was computed on, its center is taken as the hpcp's time", "[1,inf)", 2048);
+    declareParameter("hopSize", "the number of samples between consecutive hpcp frames", "[1,inf)", 1024);
+    declareParameter("keyMemory", "the time constant of the key profile [s]", "(0,inf)", 20.);
+    declareParameter("chordWindow", "the length of the chord profile [s]", "(0,inf)", 1.);
+    declareParameter("profileType", "the key profiles", "{krumhansl,temperley}", "krumhansl");
+  }
+
+  using Algorithm::configure;
+  void configure();
+  AlgorithmStatus process();
+  void clear();
+  void skipFrames(int count);
+
+  static const char* name;
+  static const char* category;
+  static const char* description;
+};
+
+#endif /* MLTKTonal_h */
@@ -0,0 +1,351 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "ofxMLTKBatch.h"
+#include "ofxMLTKEngine.h"
+#include "algorithms/MLTKChunkedLoader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <sys/stat.h>
+
+static long long fileSize(const string &path){
+  struct stat st;
+  if(stat(path.c_str(), &st) != 0) return -1;
+  return (long long) st.st_size;
+}
+
+static bool fileExists(const string &path){
+  struct stat st;
+  return stat(path.c_str(), &st) == 0;
+}
+
+// FNV-1a, stable across platforms and runs unlike std::hash, so a resumed
+// batch finds the files an earlier run wrote
+static unsigned int hashPath(const string &path){
+  unsigned int h = 2166136261u;
+  for(unsigned char c : path){
+    h ^= c;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+void MLTKBatch::run(const vector<string> &files){
+  stopping = false;
+  filesDone = 0;
+  filesSkipped = 0;
+  filesFailed = 0;
+
+  jobs.clear();
+  for(const string &file : files){
+    jobs.push_back({ file, fileSize(file) });
+  }
+
+  // Longest tracks first, so the last job a worker picks up is a short one
+  // and the threads finish at roughly the same time
+  stable_sort(jobs.begin(), jobs.end(), [](const Job &a, const Job &b){
+    return a.size > b.size;
+  });
+  nextJob = 0;
+
+  mkdir(outputDirectory.c_str(), 0755);
+
+  // The registry is built once and only read from by the workers
+  MLTKEngine::acquire();
+
+  int n = numberOfThreads > 0 ? numberOfThreads : (int) std::thread::hardware_concurrency();
+  if(n < 1) n = 1;
+
+  cout << "-------- analysing " << jobs.size() << " files on " << n << " threads --------" << endl;
+
+  vector<std::thread> workers;
+  for(int i = 0; i < n; i++){
+    workers.push_back(std::thread(&MLTKBatch::worker, this));
+  }
+  for(std::thread &t : workers){
+    t.join();
+  }
+
+  MLTKEngine::release();
+
+  cout << "-------- " << filesDone << " analysed, "
+       << filesSkipped << " already done, "
+       << filesFailed << " failed --------" << endl;
+}
+
+void MLTKBatch::stop(){
+  stopping = true;
+}
+
+string MLTKBatch::outputFileName(const string &file){
+  // the file's stem keeps the output readable, the hash of the full path
+  // keeps tracks with the same name in different folders apart
+  size_t slash = file.find_last_of("/\\");
+  string stem = slash == string::npos ? file : file.substr(slash + 1);
+  size_t dot = stem.find_last_of('.');
+  if(dot != string::npos && dot > 0) stem = stem.substr(0, dot);
+
+  ostringstream name;
+  name << outputDirectory << "/" << stem << "."
+       << hex << hashPath(file) << "." << format;
+  return name.str();
+}
+
+void MLTKBatch::worker(){
+  while(!stopping){
+    size_t i = nextJob++;
+    if(i >= jobs.size()) break;
+
+    if(fileExists(outputFileName(jobs[i].file))){
+      filesSkipped++;
+      continue;
+    }
+
+    try {
+      analyze(jobs[i]);
+      filesDone++;
+    } catch (std::exception &e) {
+      // EssentiaException, but also bad_alloc and whatever the decoders
+      // throw, escaping the thread would take the app down
+      cerr << "MLTKBatch: " << jobs[i].file << ": " << e.what() << endl;
+      filesFailed++;
+    }
+  }
+}
+
+void MLTKBatch::analyze(const Job &job){
+  essentia::streaming::AlgorithmFactory& f = essentia::streaming::AlgorithmFactory::instance();
+
+  Pool pool;
+  {
+    Algorithm *loader;
+    if(chunkedDecoding && MLTKChunkedLoader::canStream(job.file)){
+      loader = new MLTKChunkedLoader();
+      loader->configure("filename", job.file,
+                        "sampleRate", sampleRate,
+                        "maxMemory", maxDecodeMemory);
+    } else {
+      if(chunkedDecoding){
+        // the whole track ends up in memory, say so
+        cerr << "MLTKBatch: " << job.file << ": no chunked decoder for this format, decoded whole with MonoLoader" << endl;
+      }
+      loader = f.create("MonoLoader",
+                        "filename", job.file,
+                        "sampleRate", sampleRate);
+    }
+
+    connect(loader, pool);
+
+    MLTKCache cache;
+    MLTKCache::Hash fileHash = 0;
+    map<string, MLTKCache::Hash> branches;
+    if(!cacheDirectory.empty()){
+      cache.directory = cacheDirectory;
+      fileHash = MLTKCache::hashFile(job.file);
+      branches = MLTKCache::hashBranches(loader);
+
+      set<string> cached = cache.load(fileHash, branches, pool);
+      // a chain without any pool output is never a hit
+      if(!branches.empty() && cached.size() == branches.size()){
+        // everything is cached, nothing gets decoded
+        scheduler::deleteNetwork(loader);
+        loader = NULL;
+      } else {
+        MLTKCache::prune(loader, cached);
+      }
+    }
+
+    if(loader){
+      // the network owns every algorithm reachable from the loader and
+      // deletes them when it goes out of scope
+      scheduler::Network network(loader);
+      network.run();
+
+      if(!cacheDirectory.empty()) cache.store(fileHash, branches, pool);
+    }
+  }
+
+  write(job.file, pool);
+}
+
+void MLTKBatch::runSegmented(const string &file){
+  stopping = false;
+  filesDone = 0;
+  filesSkipped = 0;
+  filesFailed = 0;
+
+  if(fileExists(outputFileName(file))){
+    filesSkipped++;
+    return;
+  }
+
+  if(!MLTKChunkedLoader::canOpen(file)){
+    throw EssentiaException("MLTKBatch: can't seek in ", file, ", only formats read by libsndfile can be segmented");
+  }
+
+  mkdir(outputDirectory.c_str(), 0755);
+
+  MLTKEngine::acquire();
+
+  long long numberOfSamples;
+  try {
+    MLTKChunkedLoader loader;
+    loader.configure("filename", file, "sampleRate", sampleRate);
+    numberOfSamples = loader.numberOfSamples();
+  } catch (...) {
+    MLTKEngine::release();
+    throw;
+  }
+
+  // with frames starting at zero, frame n covers [n * hopSize, n * hopSize + frameSize)
+  // and the last one is the first frame reaching the end of the file
+  int numberOfFrames = 1;
+  if(numberOfSamples > frameSize){
+    numberOfFrames = (int) ((numberOfSamples - frameSize + hopSize - 1) / hopSize) + 1;
+  }
+
+  int n = numberOfThreads > 0 ? numberOfThreads : (int) std::thread::hardware_concurrency();
+  if(n < 1) n = 1;
+
+  // at least one segment per worker, even when the file is shorter than
+  // n segments
+  int framesPerSegment = max(1, (int) (segmentLength * sampleRate / hopSize));
+  int numberOfSegments = (numberOfFrames + framesPerSegment - 1) / framesPerSegment;
+  if(numberOfSegments < n){
+    numberOfSegments = min(n, numberOfFrames);
+    framesPerSegment = (numberOfFrames + numberOfSegments - 1) / numberOfSegments;
+    numberOfSegments = (numberOfFrames + framesPerSegment - 1) / framesPerSegment;
+  }
+
+  cout << "-------- analysing " << file << " in " << numberOfSegments
+       << " segments on " << n << " threads --------" << endl;
+
+  vector<Pool> segments(numberOfSegments);
+  atomic<int> nextSegment{0};
+  string error;
+  std::mutex errorMutex;
+
+  vector<std::thread> workers;
+  for(int i = 0; i < n; i++){
+    workers.push_back(std::thread([&](){
+      while(!stopping){
+        int s = nextSegment++;
+        if(s >= numberOfSegments) break;
+
+        int first = s * framesPerSegment;
+        int last = min(first + framesPerSegment, numberOfFrames);
+        try {
+          analyzeFrames(file, first, last, segments[s], chain,
+                        sampleRate, frameSize, hopSize, segmentLeadIn, maxDecodeMemory);
+        } catch (std::exception &e) {
+          // one missing segment would shift every frame after it, so give
+          // up on the whole file
+          std::lock_guard<std::mutex> lock(errorMutex);
+          error = e.what();
+          stopping = true;
+        }
+      }
+    }));
+  }
+  for(std::thread &t : workers){
+    t.join();
+  }
+
+  if(!error.empty()){
+    cerr << "MLTKBatch: " << file << ": " << error << endl;
+    filesFailed++;
+  } else if(!stopping){
+    // the segments hold consecutive frames, appending them in order gives
+    // the same descriptor streams as a sequential run
+    Pool pool;
+    for(int s = 0; s < numberOfSegments; s++){
+      const map<string, vector<Real> > &reals = segments[s].getRealPool();
+      for(map<string, vector<Real> >::const_iterator it = reals.begin(); it != reals.end(); ++it){
+        for(size_t i = 0; i < it->second.size(); i++) pool.add(it->first, it->second[i]);
+      }
+      const map<string, vector<vector<Real> > > &vectors = segments[s].getVectorRealPool();
+      for(map<string, vector<vector<Real> > >::const_iterator it = vectors.begin(); it != vectors.end(); ++it){
+        for(size_t i = 0; i < it->second.size(); i++) pool.add(it->first, it->second[i]);
+      }
+      segments[s].clear();
+    }
+
+    write(file, pool);
+    filesDone++;
+  }
+
+  MLTKEngine::release();
+}
+
+// Connects the chain to the loader, or frees the loader if that fails
+void MLTKBatch::connect(Algorithm *loader, Pool &pool){
+  essentia::streaming::AlgorithmFactory& f = essentia::streaming::AlgorithmFactory::instance();
+  try {
+    if(chain){
+      chain(f, loader->output("audio"), pool);
+    } else {
+      connectDefaultChain(f, loader->output("audio"), pool);
+    }
+  } catch (...) {
+    scheduler::deleteNetwork(loader);
+    throw;
+  }
+}
+
+void MLTKBatch::write(const string &file, Pool &pool){
+  Pool poolAggr;
+  if(aggregate){
+    essentia::standard::Algorithm *aggr = essentia::standard::AlgorithmFactory::create("PoolAggregator");
+    aggr->input("input").set(pool);
+    aggr->output("output").set(poolAggr);
+    aggr->compute();
+    delete aggr;
+  }
+
+  // write next to the final name and rename once complete, a crash never
+  // leaves a truncated feature file behind that a resumed batch would skip
+  string fileName = outputFileName(file);
+  string partName = fileName + ".part";
+
+  essentia::standard::Algorithm *output = essentia::standard::AlgorithmFactory::create("YamlOutput",
+                                                                                      "filename", partName,
+                                                                                      "format", format);
+  output->input("pool").set(aggregate ? poolAggr : pool);
+  output->compute();
+  delete output;
+
+  if(std::rename(partName.c_str(), fileName.c_str()) != 0){
+    throw EssentiaException("MLTKBatch: could not write ", fileName);
+  }
+}
+
+void MLTKBatch::connectDefaultChain(essentia::streaming::AlgorithmFactory& f, SourceBase& signal, Pool& pool){
+  ::connectDefaultChain(f, signal, pool, sampleRate, frameSize, hopSize);
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef ofxMLTKBatch_h
+#define ofxMLTKBatch_h
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "ofxMLTKCache.h"
+#include "ofxMLTKChain.h"
+#include "scheduler/network.h"
+
+using namespace std;
+using namespace essentia;
+using namespace streaming;
+using namespace scheduler;
+
+// Offline analysis of large collections of audio files.
+//
+// Each worker thread builds its own Network per track from the shared
+// algorithm registry, so no streaming state is shared between threads.
+// Tracks are handed out largest first from a single work queue which keeps
+// all the cores busy until the very end of the batch. Every track gets its
+// own feature file, written under a temporary name and renamed once
+// complete, so a crashed batch can be restarted and skips finished tracks.
+class MLTKBatch {
+public:
+  int sampleRate = 44100;
+  int frameSize = 2048;
+  int hopSize = 1024;
+
+  // 0 uses one worker per hardware thread
+  int numberOfThreads = 0;
+
+  // Where the feature files go, and in which format (json or yaml)
+  string outputDirectory = "features";
+  string format = "json";
+
+  // Write the PoolAggregator statistics instead of every frame
+  bool aggregate = false;
+
+  // Decode in chunks with MLTKChunkedLoader so memory does not grow with
+  // the length of the track. Formats neither libsndfile nor ffmpeg can
+  // decode still go through MonoLoader, with a warning.
+  bool chunkedDecoding = true;
+  float maxDecodeMemory = 16;   // MB of prefetched audio per worker
+
+  // Reuse descriptors from earlier runs over the same file contents and
+  // the same chain branches, empty disables the cache
+  string cacheDirectory = "";
+
+  // Leave empty to use connectDefaultChain(). runSegmented() needs one
+  // token per hop for every descriptor.
+  MLTKChain chain;
+
+  // Splitting one long file with runSegmented(): seconds per segment, and
+  // seconds of warm-up analysed and thrown away before each segment
+  float segmentLength = 60;
+  float segmentLeadIn = 2;
+
+  // Progress, safe to read from another thread while run() is working
+  atomic<int> filesDone{0}, filesSkipped{0}, filesFailed{0};
+
+  // Analyses every file in the list, blocks until the batch is complete
+  // or stop() is called
+  void run(const vector<string> &files);
+  void stop();
+
+  // Analyses a single file on all the workers at once, by cutting it into
+  // time segments and stitching their frames back together in order. Each
+  // segment starts on the hop grid, so the frames match a sequential run.
+  // The lead-in only warms up stateful algorithms, so values right after a
+  // segment boundary can differ from a sequential run. With the default
+  // chain and 2 s of lead-in, DCRemoval's 40 Hz high pass has decayed far
+  // below float precision, so those values differ only by float rounding.
+  // Files at another rate than sampleRate are resampled from the nearest
+  // input sample on the output grid before the segment (see
+  // MLTKChunkedLoader::reset()), so the samples also line up, but the
+  // converter's position is accumulated over a different span: expect
+  // differences at the level of its rounding too, far below the 97 dB
+  // signal to noise ratio of SRC_SINC_FASTEST.
+  void runSegmented(const string &file);
+
+  // The feature file a track is written to
+  string outputFileName(const string &file);
+
+  // The frame based part of MLTK's default algorithm stream
+  void connectDefaultChain(essentia::streaming::AlgorithmFactory& f, SourceBase& signal, Pool& pool);
+
+protected:
+  struct Job {
+    string file;
+    long long size;
+  };
+
+  vector<Job> jobs;
+  atomic<size_t> nextJob{0};
+  atomic<bool> stopping{false};
+
+  void worker();
+  void analyze(const Job &job);
+  void connect(Algorithm *loader, Pool &pool);
+  void write(const string &file, Pool &pool);
+};
+
+#endif /* ofxMLTKBatch_h */
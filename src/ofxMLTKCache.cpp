@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "ofxMLTKCache.h"
+#include "streaming/algorithms/devnull.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+// 64 bit FNV-1a, stable across platforms and runs
+static const MLTKCache::Hash offsetBasis = 14695981039346656037ULL;
+static const MLTKCache::Hash prime = 1099511628211ULL;
+
+static MLTKCache::Hash mix(MLTKCache::Hash h, const char *data, size_t size){
+  for(size_t i = 0; i < size; i++){
+    h ^= (unsigned char) data[i];
+    h *= prime;
+  }
+  return h;
+}
+
+static MLTKCache::Hash mix(MLTKCache::Hash h, const string &s){
+  // the terminating zero keeps "ab"+"c" and "a"+"bc" apart
+  return mix(h, s.c_str(), s.size() + 1);
+}
+
+static MLTKCache::Hash mix(MLTKCache::Hash h, MLTKCache::Hash value){
+  return mix(h, (const char*) &value, sizeof(value));
+}
+
+// Parameters that don't change what an algorithm outputs. The file name is
+// covered by the content hash, so renamed or moved files still hit.
+static bool ignoredParameter(const string &name){
+  return name == "filename" || name == "chunkSize" || name == "maxMemory";
+}
+
+static vector<Algorithm*> children(Algorithm *algo){
+  vector<Algorithm*> result;
+  for(Algorithm::OutputMap::const_iterator output = algo->outputs().begin(); output != algo->outputs().end(); ++output){
+    const vector<SinkBase*> &sinks = output->second->sinks();
+    for(size_t i = 0; i < sinks.size(); i++){
+      if(sinks[i]->parent()) result.push_back(sinks[i]->parent());
+    }
+  }
+  return result;
+}
+
+static void collect(Algorithm *algo, vector<Algorithm*> &nodes, set<Algorithm*> &visited){
+  if(!visited.insert(algo).second) return;
+  nodes.push_back(algo);
+  vector<Algorithm*> next = children(algo);
+  for(size_t i = 0; i < next.size(); i++){
+    collect(next[i], nodes, visited);
+  }
+}
+
+// Name and parameters of the algorithm, then for each input (in declaration
+// order) the output it's connected to and the hash of that output's algorithm
+static MLTKCache::Hash hashNode(Algorithm *algo, map<Algorithm*, MLTKCache::Hash> &memo){
+  map<Algorithm*, MLTKCache::Hash>::iterator found = memo.find(algo);
+  if(found != memo.end()) return found->second;
+
+  MLTKCache::Hash h = mix(offsetBasis, algo->name());
+
+  const ParameterMap &parameters = algo->defaultParameters();
+  for(ParameterMap::const_iterator it = parameters.begin(); it != parameters.end(); ++it){
+    if(ignoredParameter(it->first)) continue;
+    h = mix(h, it->first);
+    try {
+      h = mix(h, algo->parameter(it->first).toString());
+    } catch (EssentiaException &) {
+      // parameters without a default value that were never configured
+      h = mix(h, string("<unset>"));
+    }
+  }
+
+  for(Algorithm::InputMap::const_iterator input = algo->inputs().begin(); input != algo->inputs().end(); ++input){
+    h = mix(h, input->first);
+    SourceBase *source = input->second->source();
+    if(source && source->parent()){
+      h = mix(h, source->name());
+      h = mix(h, hashNode(source->parent(), memo));
+    }
+  }
+
+  PoolStorageBase *storage = dynamic_cast<PoolStorageBase*>(algo);
+  if(storage) h = mix(h, storage->descriptorName());
+
+  memo[algo] = h;
+  return h;
+}
+
+MLTKCache::Hash MLTKCache::hashFile(const string &fileName){
+  ifstream file(fileName.c_str(), ios::binary);
+  if(!file) throw EssentiaException("MLTKCache: could not read ", fileName);
+
+  Hash h = offsetBasis;
+  vector<char> block(1 << 20);
+  while(file){
+    file.read(&block[0], block.size());
+    h = mix(h, &block[0], (size_t) file.gcount());
+  }
+  return h;
+}
+
+map<string, MLTKCache::Hash> MLTKCache::hashBranches(Algorithm *source){
+  vector<Algorithm*> nodes;
+  set<Algorithm*> visited;
+  collect(source, nodes, visited);
+
+  map<string, Hash> branches;
+  map<Algorithm*, Hash> memo;
+  for(size_t i = 0; i < nodes.size(); i++){
+    PoolStorageBase *storage = dynamic_cast<PoolStorageBase*>(nodes[i]);
+    if(storage) branches[storage->descriptorName()] = hashNode(storage, memo);
+  }
+  return branches;
+}
+
+string MLTKCache::entryName(Hash file, Hash branch){
+  ostringstream name;
+  name << directory << "/" << hex << file << "/" << branch;
+  return name.str();
+}
+
+// Entry layout: type (0 = one Real per frame, 1 = one vector per frame),
+// number of frames, then the frames, vectors prefixed by their size
+set<string> MLTKCache::load(Hash file, const map<string, Hash> &branches, Pool &pool){
+  set<string> cached;
+
+  for(map<string, Hash>::const_iterator it = branches.begin(); it != branches.end(); ++it){
+    ifstream entry(entryName(file, it->second).c_str(), ios::binary);
+    if(!entry) continue;
+
+    int type = 0;
+    long long frames = 0;
+    entry.read((char*) &type, sizeof(type));
+    entry.read((char*) &frames, sizeof(frames));
+    if(!entry) continue;
+
+    if(type == 0){
+      vector<Real> values(frames);
+      if(frames > 0) entry.read((char*) &values[0], frames * sizeof(Real));
+      if(!entry) continue;
+      for(long long i = 0; i < frames; i++){
+        pool.add(it->first, values[i]);
+      }
+    } else {
+      vector<vector<Real> > values(frames);
+      for(long long i = 0; i < frames && entry; i++){
+        int size = 0;
+        entry.read((char*) &size, sizeof(size));
+        values[i].resize(size);
+        if(size > 0) entry.read((char*) &values[i][0], size * sizeof(Real));
+      }
+      if(!entry) continue;
+      for(long long i = 0; i < frames; i++){
+        pool.add(it->first, values[i]);
+      }
+    }
+    cached.insert(it->first);
+  }
+  return cached;
+}
+
+void MLTKCache::store(Hash file, const map<string, Hash> &branches, const Pool &pool){
+  mkdir(directory.c_str(), 0755);
+  ostringstream fileDirectory;
+  fileDirectory << directory << "/" << hex << file;
+  mkdir(fileDirectory.str().c_str(), 0755);
+
+  for(map<string, Hash>::const_iterator it = branches.begin(); it != branches.end(); ++it){
+    string name = entryName(file, it->second);
+    struct stat st;
+    if(stat(name.c_str(), &st) == 0) continue;
+
+    // written next to the entry and renamed, concurrent workers and crashes
+    // never leave a partial entry behind
+    string partName = name + ".part";
+    ofstream entry(partName.c_str(), ios::binary);
+
+    if(pool.getRealPool().count(it->first)){
+      const vector<Real> &values = pool.getRealPool().find(it->first)->second;
+      int type = 0;
+      long long frames = values.size();
+      entry.write((const char*) &type, sizeof(type));
+      entry.write((const char*) &frames, sizeof(frames));
+      if(frames > 0) entry.write((const char*) &values[0], frames * sizeof(Real));
+    } else if(pool.getVectorRealPool().count(it->first)){
+      const vector<vector<Real> > &values = pool.getVectorRealPool().find(it->first)->second;
+      int type = 1;
+      long long frames = values.size();
+      entry.write((const char*) &type, sizeof(type));
+      entry.write((const char*) &frames, sizeof(frames));
+      for(long long i = 0; i < frames; i++){
+        int size = values[i].size();
+        entry.write((const char*) &size, sizeof(size));
+        if(size > 0) entry.write((const char*) &values[i][0], size * sizeof(Real));
+      }
+    } else {
+      // strings and other types are always recomputed
+      entry.close();
+      std::remove(partName.c_str());
+      continue;
+    }
+
+    entry.close();
+    if(entry) std::rename(partName.c_str(), name.c_str());
+    else std::remove(partName.c_str());
+  }
+}
+
+// Whether the algorithm feeds at least one descriptor that isn't cached.
+// Algorithms that don't feed the pool at all are kept.
+static bool feedsUncached(Algorithm *algo, const set<string> &cached, map<Algorithm*, bool> &memo){
+  map<Algorithm*, bool>::iterator found = memo.find(algo);
+  if(found != memo.end()) return found->second;
+
+  bool result;
+  PoolStorageBase *storage = dynamic_cast<PoolStorageBase*>(algo);
+  if(storage){
+    result = cached.count(storage->descriptorName()) == 0;
+  } else {
+    vector<Algorithm*> next = children(algo);
+    result = next.empty();
+    for(size_t i = 0; i < next.size() && !result; i++){
+      result = feedsUncached(next[i], cached, memo);
+    }
+  }
+
+  memo[algo] = result;
+  return result;
+}
+
+void MLTKCache::prune(Algorithm *source, const set<string> &cached){
+  vector<Algorithm*> nodes;
+  set<Algorithm*> visited;
+  collect(source, nodes, visited);
+
+  map<Algorithm*, bool> memo;
+  set<Algorithm*> removable;
+  for(size_t i = 0; i < nodes.size(); i++){
+    if(nodes[i] != source && !feedsUncached(nodes[i], cached, memo)) removable.insert(nodes[i]);
+  }
+
+  // cut the edges coming from the part of the graph that still runs...
+  set<SourceBase*> cut;
+  for(set<Algorithm*>::iterator it = removable.begin(); it != removable.end(); ++it){
+    for(Algorithm::InputMap::const_iterator input = (*it)->inputs().begin(); input != (*it)->inputs().end(); ++input){
+      SourceBase *upstream = input->second->source();
+      if(upstream && !removable.count(upstream->parent())){
+        disconnect(*upstream, *input->second);
+        cut.insert(upstream);
+      }
+    }
+  }
+
+  // ...send the outputs that only fed cached descriptors (MFCC's bands when
+  // its coefficients still feed a changed branch) to nowhere, the network
+  // refuses to run with an unconnected output...
+  for(set<SourceBase*>::iterator it = cut.begin(); it != cut.end(); ++it){
+    if((*it)->sinks().empty()) connect(**it, NOWHERE);
+  }
+
+  // ...and free the rest, connectors disconnect themselves when destroyed
+  for(set<Algorithm*>::iterator it = removable.begin(); it != removable.end(); ++it){
+    delete *it;
+  }
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef ofxMLTKCache_h
+#define ofxMLTKCache_h
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "pool.h"
+#include "streaming/streamingalgorithm.h"
+#include "streaming/algorithms/poolstorage.h"
+
+using namespace std;
+using namespace essentia;
+using namespace streaming;
+
+// On-disk cache of analysis results.
+//
+// Entries are keyed by a hash of the audio file's contents plus, for every
+// descriptor written to the pool, a canonical hash of the branch of the
+// algorithm graph that produces it: each algorithm's name and parameters
+// and the connections leading to it, up to the source. Changing one branch
+// of a chain therefore only invalidates the descriptors it feeds, and the
+// others are reused.
+//
+// Typical use, once the chain has been connected to the source:
+//
+//   map<string, Hash> branches = MLTKCache::hashBranches(source);
+//   set<string> cached = cache.load(fileHash, branches, pool);
+//   if(!branches.empty() && cached.size() == branches.size())
+//     -> done, the network never runs
+//   cache.prune(source, cached);  run the network;  cache.store(...)
+class MLTKCache {
+public:
+  typedef unsigned long long Hash;
+
+  // Entries live in directory/<file hash>/<branch hash>
+  string directory = "mltk-cache";
+
+  // Hash of the file's bytes, nothing is decoded
+  static Hash hashFile(const string &fileName);
+
+  // Descriptor name -> hash of the branch producing it, for every pool
+  // output reachable from the source
+  static map<string, Hash> hashBranches(Algorithm *source);
+
+  // Adds every cached descriptor to the pool and returns their names
+  set<string> load(Hash file, const map<string, Hash> &branches, Pool &pool);
+
+  // Writes the descriptors that aren't cached yet
+  void store(Hash file, const map<string, Hash> &branches, const Pool &pool);
+
+  // Disconnects and deletes the algorithms that only feed cached
+  // descriptors, so the network built from the source skips them. Outputs
+  // of the remaining algorithms left without a sink go to DevNull.
+  static void prune(Algorithm *source, const set<string> &cached);
+
+protected:
+  string entryName(Hash file, Hash branch);
+};
+
+#endif /* ofxMLTKCache_h */
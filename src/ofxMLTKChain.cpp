@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "ofxMLTKChain.h"
+#include "algorithms/MLTKChunkedLoader.h"
+#include "scheduler/network.h"
+
+#include <cmath>
+
+void connectDefaultChain(essentia::streaming::AlgorithmFactory& f, SourceBase& signal, Pool& pool,
+                         int sampleRate, int frameSize, int hopSize){
+  Algorithm *dcRemoval = f.create("DCRemoval", "sampleRate", sampleRate);
+  Algorithm *frameCutter = f.create("FrameCutter",
+                                    "frameSize", frameSize,
+                                    "hopSize", hopSize,
+                                    "startFromZero", true);
+  Algorithm *windowing = f.create("Windowing", "size", frameSize, "type", "hann");
+  Algorithm *spectrum = f.create("Spectrum");
+  Algorithm *rms = f.create("RMS");
+  Algorithm *mfcc = f.create("MFCC", "normalize", "unit_sum", "highFrequencyBound", 11000);
+  Algorithm *bfcc = f.create("BFCC");
+  Algorithm *gfcc = f.create("GFCC");
+  Algorithm *spectralPeaks = f.create("SpectralPeaks");
+  Algorithm *hpcp = f.create("HPCP");
+
+  signal >> dcRemoval->input("signal");
+  dcRemoval->output("signal") >> frameCutter->input("signal");
+  frameCutter->output("frame") >> windowing->input("frame");
+  windowing->output("frame") >> rms->input("array");
+  windowing->output("frame") >> spectrum->input("frame");
+  spectrum->output("spectrum") >> mfcc->input("spectrum");
+  spectrum->output("spectrum") >> bfcc->input("spectrum");
+  spectrum->output("spectrum") >> gfcc->input("spectrum");
+  spectrum->output("spectrum") >> spectralPeaks->input("spectrum");
+  spectralPeaks->output("frequencies") >> hpcp->input("frequencies");
+  spectralPeaks->output("magnitudes") >> hpcp->input("magnitudes");
+
+  // Pool Outputs
+  rms->output("rms") >> PC(pool, "RMS");
+  mfcc->output("bands") >> PC(pool, "MFCC.bands");
+  mfcc->output("mfcc") >> PC(pool, "MFCC.coefs");
+  bfcc->output("bands") >> PC(pool, "BFCC.bands");
+  bfcc->output("bfcc") >> PC(pool, "BFCC.coefs");
+  gfcc->output("bands") >> PC(pool, "GFCC.bands");
+  gfcc->output("gfcc") >> PC(pool, "GFCC.coefs");
+  hpcp->output("hpcp") >> PC(pool, "HPCP");
+}
+
+void analyzeFrames(const string &fileName, int first, int last, Pool &pool, const MLTKChain &chain,
+                   int sampleRate, int frameSize, int hopSize, float leadIn, float maxMemory){
+  essentia::streaming::AlgorithmFactory& f = essentia::streaming::AlgorithmFactory::instance();
+
+  // start on the hop grid so the frames line up with a sequential run, the
+  // loader stops at the end of the file if the last frame runs past it
+  const int leadInFrames = (int) ceil(leadIn * sampleRate / hopSize);
+  const int sourceFrame = max(0, first - leadInFrames);
+  const long long start = (long long) sourceFrame * hopSize;
+  const long long end = (long long) (last - 1) * hopSize + frameSize;
+
+  Pool segmentPool;
+  {
+    MLTKChunkedLoader *loader = new MLTKChunkedLoader();
+    loader->configure("filename", fileName,
+                      "sampleRate", sampleRate,
+                      "maxMemory", maxMemory);
+    loader->setRange(start, end);
+
+    try {
+      if(chain){
+        chain(f, loader->output("audio"), segmentPool);
+      } else {
+        connectDefaultChain(f, loader->output("audio"), segmentPool, sampleRate, frameSize, hopSize);
+      }
+    } catch (...) {
+      scheduler::deleteNetwork(loader);
+      throw;
+    }
+
+    // the network owns every algorithm reachable from the loader
+    scheduler::Network network(loader);
+    network.run();
+  }
+
+  // token i of every descriptor belongs to frame sourceFrame + i
+  const int begin = first - sourceFrame;
+  const int count = last - first;
+
+  const map<string, vector<Real> > &reals = segmentPool.getRealPool();
+  for(map<string, vector<Real> >::const_iterator it = reals.begin(); it != reals.end(); ++it){
+    for(int i = begin; i < begin + count && i < (int) it->second.size(); i++){
+      pool.add(it->first, it->second[i]);
+    }
+  }
+
+  const map<string, vector<vector<Real> > > &vectors = segmentPool.getVectorRealPool();
+  for(map<string, vector<vector<Real> > >::const_iterator it = vectors.begin(); it != vectors.end(); ++it){
+    for(int i = begin; i < begin + count && i < (int) it->second.size(); i++){
+      pool.add(it->first, it->second[i]);
+    }
+  }
+}
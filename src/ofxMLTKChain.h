@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef ofxMLTKChain_h
+#define ofxMLTKChain_h
+
+#pragma once
+
+#include <functional>
+
+#include "algorithmfactory.h"
+#include "pool.h"
+#include "streaming/streamingalgorithm.h"
+#include "streaming/algorithms/poolstorage.h"
+
+using namespace std;
+using namespace essentia;
+using namespace streaming;
+
+// A chain connects the offline analysis of a signal. It receives the
+// factory, the decoded mono signal and the pool its descriptors should end
+// up in. Everything it creates must be reachable from the signal so that
+// it is owned (and freed) by the Network built from the signal's source.
+typedef function<void(essentia::streaming::AlgorithmFactory&, SourceBase&, Pool&)> MLTKChain;
+
+// The frame based part of MLTK's default algorithm stream. Frames start at
+// zero and every descriptor is produced once per hop.
+void connectDefaultChain(essentia::streaming::AlgorithmFactory& f, SourceBase& signal, Pool& pool,
+                         int sampleRate, int frameSize, int hopSize);
+
+// Runs a chain (the default one if it's empty) over frames [first, last) of
+// a file, decoding it with MLTKChunkedLoader from a lead-in of leadIn
+// seconds on the hop grid before the first frame, so stateful algorithms
+// are warmed up at the boundary. The lead-in frames and the padded frames
+// past last are dropped: token i of every descriptor in the pool belongs
+// to frame first + i. Used by MLTKTimeline and MLTKBatch::runSegmented().
+void analyzeFrames(const string &fileName, int first, int last, Pool &pool, const MLTKChain &chain,
+                   int sampleRate, int frameSize, int hopSize, float leadIn, float maxMemory);
+
+#endif /* ofxMLTKChain_h */
@@ -0,0 +1,1416 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "ofxMLTKCore.h"
+#include "algorithms/MLTKBeatTracker.h"
+#include "algorithms/MLTKCepstrum.h"
+#include "algorithms/MLTKConstantQ.h"
+#include "algorithms/MLTKHarmonicRemix.h"
+#include "algorithms/MLTKLPC.h"
+#include "algorithms/MLTKLoudness.h"
+#include "algorithms/MLTKMelody.h"
+#include "algorithms/MLTKNNLSChroma.h"
+#include "algorithms/MLTKNovelty.h"
+#include "algorithms/MLTKOnsetDetector.h"
+#include "algorithms/MLTKOverlapAdd.h"
+#include "algorithms/MLTKPitchYin.h"
+#include "algorithms/MLTKQCMonitor.h"
+#include "algorithms/MLTKSegmenter.h"
+#include "algorithms/MLTKSlidingSpectrum.h"
+#include "algorithms/MLTKSpectrum.h"
+#include "algorithms/MLTKTonal.h"
+
+template <typename... Params>
+void MLTKCore::create(map<string, Algorithm*> &m, essentia::streaming::AlgorithmFactory& f, string algo, Params... params){
+  m[algo] =  f.create(algo);
+};
+
+void MLTKCore::setupAlgorithms(essentia::streaming::AlgorithmFactory& f){
+    // Using Essentia's VectorInput type and pointing it at the audioBuffer reference
+  inputVec = new VectorInput<Real>(&audioBuffer);
+//  inputX = new VectorInput<Real>(&smoothingBuffer);
+  inputVec->setVector(&audioBuffer);
+//  inputX->setVector(&smoothingBuffer);
+
+  algorithms = {
+    // Envelope/SFX category
+    //
+    // afterMaxToBeforeMaxEnergyRatio
+    // input: pitch (real) - the array of pitch values [Hz]
+    // output: afterMaxToBeforeMaxEnergyRatio (real) - the ratio between the pitch energy after the pitch maximum to the pitch energy before the pitch maximum
+    // description: This algorithm computes the ratio between the pitch energy after the pitch maximum and the pitch energy before the pitch maximum. Sounds having an monotonically ascending pitch or one unique pitch will show a value of (0,1], while sounds having a monotonically descending pitch will show a value of [1,∞). In case there is no energy before the max pitch, the algorithm will return the energy after the maximum pitch.
+    //
+    //The algorithm throws exception when input is either empty or contains only zeros.
+    { "AfterMaxToBeforeMaxEnergyRatio", f.create("AfterMaxToBeforeMaxEnergyRatio") },
+    
+    // DerivativeSFX
+    // inputs: envelope (vector_real) - the envelope of the signal
+    // output: derAvAfterMax (real) - the weighted average of the derivative after the maximum amplitude
+    // output: maxDerBeforeMax (real) - the maximum derivative before the maximum amplitude
+    // This algorithm computes two descriptors that are based on the derivative of a signal envelope.
+    //
+    // The first descriptor is calculated after the maximum value of the input signal occurred. It is the average of the signal's derivative weighted by its amplitude. This coefficient helps discriminating impulsive sounds, which have a steep release phase, from non-impulsive sounds. The smaller the value the more impulsive.
+    //
+    // The second descriptor is the maximum derivative, before the maximum value of the input signal occurred. This coefficient helps discriminating sounds that have a smooth attack phase, and therefore a smaller value than sounds with a fast attack.
+    //
+    // This algorithm is meant to be fed by the outputs of the Envelope algorithm. If used in streaming mode, RealAccumulator should be connected in between. An exception is thrown if the input signal is empty.
+    //
+    // See also: Envelope (streaming) RealAccumulator (streaming)
+    { "DerivativeSFX", f.create("DerivativeSFX") },
+    
+    // Envelope
+    // input: signal (real) - the input signal
+    // output: signal (real) - the resulting envelope of the signal
+    // Params:
+    //   applyRectification (bool ∈ {true, false}, default = true) : whether to apply rectification (envelope based on the absolute value of signal)
+    //   attackTime (real ∈ [0, ∞), default = 10) : the attack time of the first order lowpass in the attack phase [ms]
+    //   releaseTime (real ∈ [0, ∞), default = 1500) : the release time of the first order lowpass in the release phase [ms]
+    //   sampleRate (real ∈ (0, ∞), default = 44100) : the audio sampling rate [Hz]
+    //
+    // This algorithm computes the envelope of a signal by applying a non-symmetric lowpass filter on a signal. By default it rectifies the signal, but that is optional.
+    // References:
+    // [1] U. Zölzer, Digital Audio Signal Processing, John Wiley & Sons Ltd, 1997, ch.7
+    { "Envelope", f.create("Envelope") },
+    
+    // FlatnessSFX
+    // input: envelope (vector_real) - the envelope of the signal
+    // output: flatness (real) - the flatness coefficient
+    // description: This algorithm calculates the flatness coefficient of a signal envelope.
+    //
+    // There are two thresholds defined: a lower one at 20% and an upper one at 95%. The thresholds yield two values: one value which has 20% of the total values underneath, and one value which has 95% of the total values underneath. The flatness coefficient is then calculated as the ratio of these two values. This algorithm is meant to be plugged after Envelope algorithm, however in streaming mode a RealAccumulator algorithm should be connected in between the two. In the current form the algorithm can't be calculated in streaming mode, since it would violate the streaming mode policy of having low memory consumption.
+    //
+    // An exception is thrown if the input envelope is empty.
+    //
+    // See Also: Envelope (streaming) RealAccumulator (streaming)
+    { "FlatnessSFX", f.create("FlatnessSFX") },
+    
+    // LogAttackTime
+    //
+    // input: signal (vector_real) - the input signal envelope (must be non-empty)
+    //
+    // output:
+    //   logAttackTime (real) - the log (base 10) of the attack time [log10(s)]
+    //   attackStart (real) - the attack start time [s]
+    //   attackStop (real) - the attack end time [s]
+    //
+    // Parameters:
+    //   sampleRate (real ∈ (0, ∞), default = 44100) : the audio sampling rate [Hz]
+    //   startAttackThreshold (real ∈ [0, 1], default = 0.2) : the percentage of the input signal envelope at which the starting point of the attack is considered
+    //   stopAttackThreshold (real ∈ [0, 1], default = 0.9) : the percentage of the input signal envelope at which the ending point of the attack is considered
+    //
+    // Description:
+    //   This algorithm computes the log (base 10) of the attack time of a signal envelope. The attack time is defined as the time duration from when the sound becomes perceptually audible to when it reaches its maximum intensity. By default, the start of the attack is estimated as the point where the signal envelope reaches 20% of its maximum value in order to account for possible noise presence. Also by default, the end of the attack is estimated as as the point where the signal envelope has reached 90% of its maximum value, in order to account for the possibility that the max value occurres after the logAttack, as in trumpet sounds.
+    //
+    // With this said, LogAttackTime's input is intended to be fed by the output of the Envelope algorithm. In streaming mode, the RealAccumulator algorithm should be connected between Envelope and LogAttackTime.
+    //
+    // Note that startAttackThreshold cannot be greater than stopAttackThreshold and the input signal should not be empty. In any of these cases an exception will be thrown.
+    // See Also: Envelope (streaming) RealAccumulator (streaming)
+    { "LogAttackTime", f.create("LogAttackTime") },
+    
+    { "MaxToTotal", f.create("MaxToTotal") },
+    
+    { "MinToTotal", f.create("MinToTotal") },
+    
+    { "StrongDecay", f.create("StrongDecay") },
+    
+    { "TCToTotal", f.create("TCToTotal") },
+    
+    // Filters
+    
+    { "AllPass", f.create("AllPass") },
+    
+    { "BandPass", f.create("BandPass") },
+    
+    { "BandReject", f.create("BandReject") },
+
+    { "DCRemoval", f.create("DCRemoval",
+                            "sampleRate", sampleRate) },
+
+    { "LargeDCRemoval", f.create("DCRemoval",
+                                 "sampleRate", sampleRate) },
+
+    { "EqualLoudness", f.create("EqualLoudness") },
+    
+    { "HighPass", f.create("HighPass") },
+    
+    { "IIR", f.create("IIR") },
+    
+    { "LowPass", f.create("LowPass") },
+    
+    { "MaxFilter", f.create("MaxFilter") },
+    
+    { "MedianFilter", f.create("MedianFilter") },
+    
+    { "MovingAverage", f.create("MovingAverage") },
+    
+    // Input/output
+    
+    { "AudioLoader", f.create("AudioLoader") },
+    
+    { "AudioOnsetsMarker", f.create("AudioOnsetsMarker") },
+    
+    { "AudioWriter", f.create("AudioWriter") },
+    
+    { "EasyLoader", f.create("EasyLoader") },
+
+    { "EqloudLoader", f.create("EqloudLoader") },
+    
+    { "FileOutput", f.create("FileOutput") },
+    
+    { "MetadataReader", f.create("MetadataReader") },
+    
+    { "MonoLoader", f.create("MonoLoader") },
+    
+    { "MonoWriter", f.create("MonoWriter") },
+
+    //    Deprecated? Use data structure VectorInput instead-
+    //    { "VectorInput", f.create("VectorInput") },
+    //    { "YamlInput", f.create("YamlInput") },
+    //    { "YamlOutput", f.create("YamlOutput") },
+    
+    // Standard Algorithms
+    { "AutoCorrelation", f.create("AutoCorrelation") },
+    
+    { "BPF", f.create("BPF") },
+    
+    { "BinaryOperator", f.create("BinaryOperator") },
+    
+    { "BinaryOperatorStream", f.create("BinaryOperatorStream") },
+    
+    { "Clipper", f.create("Clipper") },
+    
+    { "ConstantQ", f.create("ConstantQ") },
+    
+    { "CrossCorrelation", f.create("CrossCorrelation") },
+    
+    { "CubicSpline", f.create("CubicSpline") },
+    
+    { "DCT", f.create("DCT") },
+    
+    { "Derivative", f.create("Derivative") },
+    
+    { "FFT", f.create("FFT") },
+    
+    { "FFTC", f.create("FFTC") },
+        
+        
+    //    FrameCutter
+    //    streaming mode | Standard category
+    //
+    //    Inputs
+    //    signal (real) - the input audio signal
+    //    Outputs
+    //    frame (vector_real) - the frames of the audio signal
+    //    Parameters
+    //      frameSize (integer ∈ [1, ∞), default = 1024) : the size of the frame to cut
+    //      hopSize (integer ∈ [1, ∞), default = 512) : the number of samples to jump after a frame is output
+    //      lastFrameToEndOfFile (bool ∈ {true, false}, default = false) : whether the beginning of the last frame should reach the end of file. Only applicable if startFromZero is true
+    //      silentFrames (string ∈ {drop, keep, noise}, default = noise) : whether to [keep/drop/add noise to] silent frames
+    //      startFromZero (bool ∈ {true, false}, default = false) : whether to start the first frame at time 0 (centered at frameSize/2) if true, or -frameSize/2 otherwise (zero-centered)
+    //      validFrameThresholdRatio (real ∈ [0, 1], default = 0) : frames smaller than this ratio will be discarded, those larger will be zero-padded to a full frame (i.e. a value of 0 will never discard frames and a value of 1 will only keep frames that are of length 'frameSize')
+    //
+    //    Description:
+    //    This algorithm slices the input buffer into frames. It returns a frame of a constant size and jumps a constant amount of samples forward in the buffer on every compute() call until no more frames can be extracted; empty frame vectors are returned afterwards. Incomplete frames (frames starting before the beginning of the input buffer or going past its end) are zero-padded or dropped according to the "validFrameThresholdRatio" parameter.
+    //
+    //    The algorithm outputs as many frames as needed to consume all the information contained in the input buffer. Depending on the "startFromZero" parameter:
+    //
+    //    startFromZero = true: a frame is the last one if its end position is at or beyond the end of the stream. The last frame will be zero-padded if its size is less than "frameSize"
+    //    startFromZero = false: a frame is the last one if its center position is at or beyond the end of the stream
+    //    In both cases the start time of the last frame is never beyond the end of the stream.
+    //
+    //    run() hands the network a buffer holding exactly the frames that
+    //    became complete since the last call (frameSize + (n-1) * hopSize
+    //    samples), so frames start at zero and end on the buffer boundary.
+    { "FrameCutter", f.create("FrameCutter",
+                              "frameSize", frameSize,
+                              "hopSize", hopSize,
+                              "startFromZero", true) },
+
+    { "LargeFrameCutter", f.create("FrameCutter",
+                                    "frameSize", 32768,
+                                    "hopSize", 16384) },
+
+//                                    ) },
+//
+    //    Python Only
+    //    { "FrameGenerator", f.create("FrameGenerator") },
+    
+    { "FrameToReal", f.create("FrameToReal") },
+    
+    { "IDCT", f.create("IDCT") },
+    
+    { "IFFT", f.create("IFFT") },
+    
+    { "IFFTC", f.create("IFFTC") },
+    
+    { "MonoMixer", f.create("MonoMixer") },
+    
+    { "Multiplexer", f.create("Multiplexer") },
+    
+    { "NSGConstantQ", f.create("NSGConstantQ") },
+    
+    { "NSGConstantQStreaming", f.create("NSGConstantQStreaming") },
+    
+    { "NSGIConstantQ", f.create("NSGIConstantQ") },
+    
+    { "NoiseAdder", f.create("NoiseAdder") },
+
+    { "OverlapAdd", f.create("OverlapAdd") },
+    
+    { "PeakDetection", f.create("PeakDetection") },
+    
+    { "RealAccumulator", f.create("RealAccumulator") },
+    
+    { "Resample", f.create("Resample") },
+    
+    { "Scale", f.create("Scale") },
+    
+    { "Slicer", f.create("Slicer") },
+    
+    { "Spline", f.create("Spline") },
+    
+    { "StereoDemuxer", f.create("StereoDemuxer") },
+    
+    { "StereoMuxer", f.create("StereoMuxer") },
+    
+    { "StereoTrimmer", f.create("StereoTrimmer") },
+        
+    { "Trimmer", f.create("Trimmer") },
+    
+    { "UnaryOperator", f.create("UnaryOperator") },
+
+    { "UnaryOperatorStream", f.create("UnaryOperatorStream") },
+    
+    { "VectorRealAccumulator", f.create("VectorRealAccumulator") },
+    
+    { "WarpedAutoCorrelation", f.create("WarpedAutoCorrelation") },
+    
+    { "Welch", f.create("Welch") },
+    
+    { "Windowing", f.create("Windowing",
+                            "size", frameSize,
+                            "type", "hann") },
+
+    { "LargeWindowing", f.create("Windowing",
+                                 "size", 32768,
+                                 "type", "hann") },
+
+    
+    { "ZeroCrossingRate", f.create("ZeroCrossingRate") },
+
+    // Spectral
+    
+    { "BFCC", f.create("BFCC") },
+    
+    { "BarkBands", f.create("BarkBands") },
+    
+    { "ERBBands", f.create("ERBBands") },
+    
+    { "EnergyBand", f.create("EnergyBand") },
+    
+    { "EnergyBandRatio", f.create("EnergyBandRatio") },
+    
+    { "FlatnessDB", f.create("FlatnessDB") },
+    
+    { "Flux", f.create("Flux") },
+    
+    { "FrequencyBands", f.create("FrequencyBands") },
+    
+    { "GFCC", f.create("GFCC") },
+    
+    { "HFC", f.create("HFC") },
+    
+    { "LPC", f.create("LPC",
+                      "order", 10) },
+    
+    { "MFCC", f.create("MFCC") },
+    
+    { "MaxMagFreq", f.create("MaxMagFreq") },
+    
+    { "MelBands", f.create("MelBands") },
+    
+    { "Panning", f.create("Panning") },
+    
+    { "PowerSpectrum", f.create("PowerSpectrum") },
+    
+    { "RollOff", f.create("RollOff") },
+    
+    { "SpectralCentroidTime", f.create("SpectralCentroidTime") },
+    
+    { "SpectralComplexity", f.create("SpectralComplexity") },
+    
+    { "SpectralContrast", f.create("SpectralContrast") },
+
+    { "SpectralPeaks", f.create("SpectralPeaks") },
+
+    { "SpectralWhitening", f.create("SpectralWhitening") },
+
+    { "SpectrumToCent", f.create("SpectrumToCent") },
+
+    { "StrongPeak", f.create("StrongPeak") },
+
+    { "TriangularBands", f.create("TriangularBands") },
+
+    { "TriangularBarkBands", f.create("TriangularBarkBands") },
+    
+    // Rhythm
+
+    { "BeatTrackerDegara", f.create("BeatTrackerDegara") },
+
+    { "BeatTrackerMultiFeature", f.create("BeatTrackerMultiFeature") },
+
+    { "Beatogram", f.create("Beatogram") },
+
+    { "BeatsLoudness", f.create("BeatsLoudness") },
+
+    { "BpmHistogram", f.create("BpmHistogram") },
+
+    { "BpmHistogramDescriptors", f.create("BpmHistogramDescriptors") },
+
+    { "Danceability", f.create("Danceability") },
+    
+    { "HarmonicBpm", f.create("HarmonicBpm") },
+    
+    { "LoopBpmConfidence", f.create("LoopBpmConfidence") },
+    
+    { "LoopBpmEstimator", f.create("LoopBpmEstimator") },
+    
+    { "Meter", f.create("Meter") },
+    
+    { "NoveltyCurve", f.create("NoveltyCurve") },
+    
+//    { "NoveltyCurveFixedBpmEstimator", f.create("NoveltyCurveFixedBpmEstimator") },
+    
+    { "OnsetDetection", f.create("OnsetDetection") },
+    
+    { "OnsetDetectionGlobal", f.create("OnsetDetectionGlobal") },
+    
+    { "OnsetRate", f.create("OnsetRate") },
+    
+    { "Onsets", f.create("Onsets") },
+    
+    { "PercivalBpmEstimator", f.create("PercivalBpmEstimator") },
+    
+    { "PercivalEnhanceHarmonics", f.create("PercivalEnhanceHarmonics") },
+    
+    { "PercivalEvaluatePulseTrains", f.create("PercivalEvaluatePulseTrains") },
+    
+    { "RhythmDescriptors", f.create("RhythmDescriptors") },
+    
+    { "RhythmExtractor2013", f.create("RhythmExtractor2013") },
+    
+    { "RhythmExtractor", f.create("RhythmExtractor") },
+    
+    { "RhythmTransform", f.create("RhythmTransform") },
+    
+    { "SuperFluxExtractor", f.create("SuperFluxExtractor") },
+    
+    { "SuperFluxNovelty", f.create("SuperFluxNovelty") },
+    
+    { "SuperFluxPeaks", f.create("SuperFluxPeaks") },
+    
+    { "TempoScaleBands", f.create("TempoScaleBands") },
+    
+    { "TempoTap", f.create("TempoTap") },
+    
+    { "TempoTapMaxAgreement", f.create("TempoTapMaxAgreement") },
+    
+    { "TempoTapTicks", f.create("TempoTapTicks") },
+    
+    // Math
+    { "CartesianToPolar", f.create("CartesianToPolar") },
+    
+    { "Magnitude", f.create("Magnitude") },
+    
+    { "PolarToCartesian", f.create("PolarToCartesian") },
+    
+    // Statistics
+    { "CentralMoments", f.create("CentralMoments") },
+    
+    { "Centroid", f.create("Centroid") },
+    
+    { "Crest", f.create("Crest") },
+    
+    { "Decrease", f.create("Decrease") },
+    
+    { "DistributionShape", f.create("DistributionShape") },
+    
+    { "Energy", f.create("Energy") },
+    
+    { "Entropy", f.create("Entropy") },
+    
+    { "Flatness", f.create("Flatness") },
+    
+    { "GeometricMean", f.create("GeometricMean") },
+    
+    { "Histogram", f.create("Histogram") },
+    
+    { "InstantPower", f.create("InstantPower") },
+    
+    { "Mean", f.create("Mean") },
+    
+    { "Median", f.create("Median") },
+    
+    { "PoolAggregator", f.create("PoolAggregator") },
+    
+    { "PowerMean", f.create("PowerMean") },
+    
+    { "RawMoments", f.create("RawMoments") },
+    
+    { "SingleGaussian", f.create("SingleGaussian") },
+    
+    { "Variance", f.create("Variance") },
+    
+    { "Viterbi", f.create("Viterbi") },
+    
+    // Tonal
+    
+    { "ChordsDescriptors", f.create("ChordsDescriptors") },
+    
+    { "ChordsDetection", f.create("ChordsDetection") },
+    
+//    { "ChordsDetectionBeats", f.create("ChordsDetectionBeats") },
+    
+    { "Chromagram", f.create("Chromagram",
+                             "binsPerOctave", 12) },
+    
+    { "Dissonance", f.create("Dissonance") },
+    
+    { "HighResolutionFeatures", f.create("HighResolutionFeatures") },
+    
+    { "Inharmonicity", f.create("Inharmonicity") },
+    
+    { "Key", f.create("Key") },
+    
+    { "KeyExtractor", f.create("KeyExtractor") },
+
+    { "NNLSChroma", f.create("NNLSChroma") },
+    
+    { "OddToEvenHarmonicEnergyRatio", f.create("OddToEvenHarmonicEnergyRatio") },
+
+    { "PitchSalience", f.create("PitchSalience") },
+    
+    { "SpectrumCQ", f.create("SpectrumCQ") },
+
+    { "TonalExtractor", f.create("TonalExtractor") },
+    
+//    { "TonicIndianArtMusic", f.create("TonicIndianArtMusic") },
+
+    { "Tristimulus", f.create("Tristimulus") },
+    
+    { "TuningFrequency", f.create("TuningFrequency") },
+
+    { "TuningFrequencyExtractor", f.create("TuningFrequencyExtractor") },
+    
+    { "Chromaprinter", f.create("Chromaprinter") },
+
+    // Audio Problems
+    
+    { "ClickDetector", f.create("ClickDetector") },
+
+    // Discontinuity Detector
+    //    Inputs:
+    //    frame (vector_real) - the input frame (must be non-empty)
+    //
+    //    Outputs:
+    //    discontinuityLocations (vector_real) - the index of the detected discontinuities (if any)
+    //    discontinuityAmplitudes (vector_real) - the peak values of the prediction error for the discontinuities (if any)
+    //
+    //    Parameters:
+    //    detectionThreshold (real ∈ [1, ∞), default = : 'detectionThreshold' times the standard deviation plus the median of the frame is used as detection threshold
+    //    energyThreshold (real ∈ (-∞, ∞), default = -60) : threshold in dB to detect silent subframes
+    //    frameSize (integer ∈ (0, ∞), default = 512) : the expected size of the input audio signal (this is an optional parameter to optimize memory allocation)
+    //    hopSize (integer ∈ [0, ∞), default = 256) : hop size used for the analysis. This parameter must be set correctly as it cannot be obtained from the input data
+    //    kernelSize (integer ∈ [1, ∞), default = 7) : scalar giving the size of the median filter window. Must be odd
+    //    order (integer ∈ [1, ∞), default = 3) : scalar giving the number of LPCs to use
+    //    silenceThreshold (integer ∈ (-∞, 0), default = -50) : threshold to skip silent frames
+    //    subFrameSize (integer ∈ [1, ∞), default = 32) : size of the window used to compute silent subframes
+    { "DiscontinuityDetector", f.create("DiscontinuityDetector") },
+
+    { "FalseStereoDetector", f.create("FalseStereoDetector") },
+    
+    { "GapsDetector", f.create("GapsDetector") },
+
+    { "HumDetector", f.create("HumDetector") },
+    
+    { "NoiseBurstDetector", f.create("NoiseBurstDetector") },
+
+    { "SNR", f.create("SNR") },
+    
+    { "SaturationDetector", f.create("SaturationDetector") },
+
+    { "StartStopCut", f.create("StartStopCut") },
+    
+    { "TruePeakDetector", f.create("TruePeakDetector") },
+
+    { "Duration", f.create("Duration") },
+    
+    { "EffectiveDuration", f.create("EffectiveDuration") },
+
+    { "FadeDetection", f.create("FadeDetection") },
+    
+    { "SilenceRate", f.create("SilenceRate") },
+
+    { "StartStopSilence", f.create("StartStopSilence") },
+    
+    // Loudness/dynamics
+    
+    { "DynamicComplexity", f.create("DynamicComplexity") },
+    
+//    { "Intensity", f.create("Intensity") },
+
+    // standard-mode only
+    //    { "Larm", f.create("Larm") },
+
+    { "Leq", f.create("Leq") },
+    
+    { "LevelExtractor", f.create("LevelExtractor") },
+
+    { "Loudness", f.create("Loudness") },
+    
+    { "LoudnessEBUR128", f.create("LoudnessEBUR128") },
+
+    { "LoudnessEBUR128Filter", f.create("LoudnessEBUR128Filter") },
+    
+    { "LoudnessVickers", f.create("LoudnessVickers") },
+
+    { "ReplayGain", f.create("ReplayGain") },
+    
+    // Extractors
+    { "BarkExtractor", f.create("BarkExtractor") },
+    
+//    { "Extractor", f.create("Extractor") },
+    
+//    { "FreesoundExtractor", f.create("FreesoundExtractor") },
+
+    { "LowLevelSpectralEqloudExtractor", f.create("LowLevelSpectralEqloudExtractor") },
+    
+    { "LowLevelSpectralExtractor", f.create("LowLevelSpectralExtractor") },
+    
+    // Synthesis
+    { "HarmonicMask", f.create("HarmonicMask") },
+    
+    { "HarmonicModelAnal", f.create("HarmonicModelAnal") },
+
+    { "HprModelAnal", f.create("HprModelAnal") },
+    
+    { "HpsModelAnal", f.create("HpsModelAnal") },
+
+    { "ResampleFFT", f.create("ResampleFFT") },
+    
+    { "SineModelAnal", f.create("SineModelAnal",
+                                "sampleRate", sampleRate) },
+    
+    { "SineModelSynth", f.create("SineModelSynth") },
+    
+    { "SineSubtraction", f.create("SineSubtraction") },
+
+    { "SprModelAnal", f.create("SprModelAnal") },
+    
+    { "SprModelSynth", f.create("SprModelSynth") },
+
+    { "SpsModelAnal", f.create("SpsModelAnal") },
+    
+    { "SpsModelSynth", f.create("SpsModelSynth") },
+
+    { "StochasticModelAnal", f.create("StochasticModelAnal") },
+    
+    { "StochasticModelSynth", f.create("StochasticModelSynth") },
+
+    // Pitch
+    { "MultiPitchMelodia", f.create("MultiPitchMelodia") },
+    
+    { "PitchContours", f.create("PitchContours") },
+    
+    { "PitchContoursMelody", f.create("PitchContoursMelody") },
+    
+    { "PitchContoursMonoMelody", f.create("PitchContoursMonoMelody") },
+    
+    { "PitchContoursMultiMelody", f.create("PitchContoursMultiMelody") },
+    
+    { "PitchFilter", f.create("PitchFilter") },
+    
+    { "PitchMelodia", f.create("PitchMelodia") },
+    
+    { "PitchSalienceFunction", f.create("PitchSalienceFunction") },
+    
+    { "PitchSalienceFunctionPeaks", f.create("PitchSalienceFunctionPeaks") },
+    
+    { "PitchYin", f.create("PitchYin") },
+    
+    { "PitchYinFFT", f.create("PitchYinFFT") },
+    
+    { "PitchYinProbabilistic", f.create("PitchYinProbabilistic") },
+    
+    { "PitchYinProbabilities", f.create("PitchYinProbabilities") },
+    
+    { "PitchYinProbabilitiesHMM", f.create("PitchYinProbabilitiesHMM") },
+    
+    { "PredominantPitchMelodia", f.create("PredominantPitchMelodia") },
+    
+    { "Vibrato", f.create("Vibrato") },
+    
+//    Standard Mode Only
+//    { "PCA", f.create("PCA") },
+
+    // Segmentation
+    { "SBic", f.create("SBic") },
+    
+    { "SpectralComplexity", f.create("SpectralComplexity") },
+    
+    { "Spectrum", f.create("Spectrum") },
+    
+    { "SpectralPeaks", f.create("SpectralPeaks")},
+    
+    { "RMS",  f.create("RMS") },
+    
+    { "HPCP", f.create("HPCP") },
+    
+    { "PoolAggregator", f.create("PoolAggregator")},
+    
+    { "BeatsLoudness", f.create("BeatsLoudness") },
+    
+    { "Beatogram", f.create("Beatogram") },
+    
+    { "Energy",  f.create("Energy") },
+    
+    { "InstantPower",  f.create("InstantPower") },
+    
+    { "Centroid",  f.create("Centroid", "range", sampleRate/2) },
+    
+    { "MFCC", f.create("MFCC",
+                       "normalize", "unit_sum",
+                       "highFrequencyBound", 11000) },
+  };
+
+  // Windowing -> Spectrum and FFT -> CartesianToPolar in one algorithm, see
+  // fusedFrontEnd
+  algorithms["MLTKSpectrum"] = new MLTKSpectrum();
+  algorithms["MLTKSpectrum"]->configure("size", frameSize,
+                                        "type", "hann",
+                                        "computePhase", true);
+
+  // MFCC, BFCC and GFCC in one pass, see fusedCepstrum
+  algorithms["MLTKCepstrum"] = new MLTKCepstrum();
+  algorithms["MLTKCepstrum"]->configure("inputSize", frameSize / 2 + 1);
+
+  // octave-wise constant-Q, see multiResolutionCQ
+  algorithms["MLTKConstantQ"] = new MLTKConstantQ();
+  algorithms["MLTKConstantQ"]->configure("sampleRate", sampleRate,
+                                         "hopSize", hopSize,
+                                         "binsPerOctave", binsPerOctave);
+
+  // LPC with a sliding autocorrelation, see incrementalLPC
+  algorithms["MLTKLPC"] = new MLTKLPC();
+  algorithms["MLTKLPC"]->configure("order", 10,
+                                   "windowSize", 32768,
+                                   "hopSize", hopSize);
+
+  // onset novelty (SuperFlux), onset picking and causal beat tracking (see
+  // beatTracking), posting onsets and beats to events
+  algorithms["MLTKNovelty"] = new MLTKNovelty();
+  algorithms["MLTKNovelty"]->configure("hopSize", hopSize);
+  algorithms["MLTKOnsetDetector"] = new MLTKOnsetDetector();
+  algorithms["MLTKOnsetDetector"]->configure("sampleRate", sampleRate,
+                                             "hopSize", hopSize);
+  algorithms["MLTKBeatTracker"] = new MLTKBeatTracker();
+  algorithms["MLTKBeatTracker"]->configure("sampleRate", sampleRate,
+                                           "frameSize", frameSize,
+                                           "hopSize", hopSize);
+
+  // key and chord from the HPCP stream, in place of Key/ChordsDetection
+  // which need the whole signal, see tonal
+  algorithms["MLTKTonal"] = new MLTKTonal();
+  algorithms["MLTKTonal"]->configure("sampleRate", sampleRate,
+                                     "frameSize", frameSize,
+                                     "hopSize", hopSize);
+
+  // EBU R128 momentary, short-term and integrated loudness, in place of
+  // LoudnessEBUR128 which needs the whole signal, see loudness
+  algorithms["MLTKLoudness"] = new MLTKLoudness();
+  algorithms["MLTKLoudness"]->configure("sampleRate", sampleRate,
+                                        "hopSize", hopSize);
+
+  // YIN pitch from an FFT autocorrelation, see yinPitch.
+  // MLTKPitchYin::compute() also takes one frame per channel at once
+  algorithms["MLTKPitchYin"] = new MLTKPitchYin();
+  algorithms["MLTKPitchYin"]->configure("frameSize", frameSize,
+                                        "sampleRate", sampleRate);
+
+  // live section boundaries from MFCC and HPCP, in place of SBic which
+  // needs the whole feature matrix, see segmenter
+  algorithms["MLTKSegmenter"] = new MLTKSegmenter();
+  algorithms["MLTKSegmenter"]->configure("sampleRate", sampleRate,
+                                         "frameSize", frameSize,
+                                         "hopSize", hopSize);
+
+  // NNLS chroma on MLTKConstantQ's spectrum and predominant melody from
+  // the spectral peaks (see melody), both with a fixed lookahead (and delay)
+  algorithms["MLTKNNLSChroma"] = new MLTKNNLSChroma();
+  algorithms["MLTKNNLSChroma"]->configure("sampleRate", sampleRate,
+                                          "hopSize", hopSize,
+                                          "binsPerOctave", binsPerOctave,
+                                          "lookahead", lookahead);
+  algorithms["MLTKMelody"] = new MLTKMelody();
+  algorithms["MLTKMelody"]->configure("sampleRate", sampleRate,
+                                      "hopSize", hopSize,
+                                      "lookahead", lookahead);
+
+  // audio problem detectors run continuously over the FrameCutter frames,
+  // see qualityMonitor
+  algorithms["MLTKQCMonitor"] = new MLTKQCMonitor();
+  algorithms["MLTKQCMonitor"]->configure("sampleRate", sampleRate,
+                                         "frameSize", frameSize,
+                                         "hopSize", hopSize);
+
+  // harmonic/noise remix and overlap-add into outputRing, see resynthesis
+  algorithms["MLTKHarmonicRemix"] = new MLTKHarmonicRemix();
+  algorithms["MLTKHarmonicRemix"]->configure("sampleRate", sampleRate,
+                                             "harmonicGain", harmonicGain,
+                                             "noiseGain", noiseGain);
+  algorithms["MLTKOverlapAdd"] = new MLTKOverlapAdd();
+  algorithms["MLTKOverlapAdd"]->configure("frameSize", frameSize,
+                                          "hopSize", hopSize,
+                                          "type", "hann");
+
+  // incremental Windowing -> Spectrum and phases for small hops, see
+  // slidingSpectrum
+  algorithms["MLTKSlidingSpectrum"] = new MLTKSlidingSpectrum();
+  algorithms["MLTKSlidingSpectrum"]->configure("size", frameSize,
+                                               "hopSize", hopSize,
+                                               "computePhase", true);
+
+  // if a file is passed, load it into one of essentia's MonoLoader objects
+  // which creates a mono data stream, demuxing stereo if needed.
+  if(fileName.length() > 0){
+    algorithms["MonoLoader"] = f.create("MonoLoader",
+                                              "filename", fileName,
+                                              "sampleRate", sampleRate);
+  }
+}
+
+//void MLTKCore::connectAlgorithmStream(essentia::streaming::AlgorithmFactory& factory){
+//  std::cout << "-------- connecting algorithm stream --------" << std::endl;
+//
+//  // We start with the incoming signal that was attached to inputVec
+//  *inputVec >> algorithms["DCRemoval"]->input("signal");
+//
+//  // Remember that all the strings match 1:1 with Essentia's reference documentation.
+//  // Algorithms can have an unlimited number of OUTPUTS but every input must
+//  // always have exactly 1 connection.
+//  // (tl;dr; inputs always need to be connected)
+//  algorithms["DCRemoval"]->output("signal") >> algorithms["FrameCutter"]->input("signal");
+//  algorithms["FrameCutter"]->output("frame") >> algorithms["Windowing"]->input("frame");
+//  algorithms["Windowing"]->output("frame") >> algorithms["RMS"]->input("array");
+//  algorithms["Windowing"]->output("frame") >> algorithms["Spectrum"]->input("frame");
+//  algorithms["Spectrum"]->output("spectrum")  >> algorithms["MFCC"]->input("spectrum");
+//  algorithms["Spectrum"]->output("spectrum") >> algorithms["SpectralPeaks"]->input("spectrum");
+//  algorithms["SpectralPeaks"]->output("frequencies") >> algorithms["HPCP"]->input("frequencies");
+//  algorithms["SpectralPeaks"]->output("magnitudes") >> algorithms["HPCP"]->input("magnitudes");
+//
+////  *inputVec >> algorithms["BeatsLoudness"]->input("signal");
+////  algorithms["BeatsLoudness"]->output("loudness") >> algorithms["Beatogram"]->input("loudness");
+////  algorithms["BeatsLoudness"]->output("loudnessBandRatio") >> algorithms["Beatogram"]->input("loudnessBandRatio");
+//
+//  // Pool Outputs
+//  algorithms["DCRemoval"]->output("signal") >> PC(pool, "DCRemoval");
+//  algorithms["FrameCutter"]->output("frame") >> PC(pool, "FrameCutter");
+//  algorithms["Windowing"]->output("frame") >> PC(pool, "Windowing");
+//  algorithms["RMS"]->output("rms") >> PC(pool, "RMS");
+//  algorithms["Spectrum"]->output("spectrum")  >>  PC(pool, "Spectrum");
+//  algorithms["MFCC"]->output("mfcc") >> PC(pool, "MFCC.coefs");
+//  algorithms["MFCC"]->output("bands") >> PC(pool, "MFCC.bands");
+//  algorithms["HPCP"]->output("hpcp") >> PC(pool, "HPCP");
+//
+//  f.shutdown();
+//}
+void MLTKCore::connectDefaultAlgorithmStream(essentia::streaming::AlgorithmFactory& factory){
+  /////////// CONNECTING DEFAULT ALGORITHMS ////////////////
+  //  w->output("frame") >> chromagram->input("frame");
+  //  chromagram->output("chromagram") >> PC(pool, "chroma");
+  //fft->input("frame");
+  //  fft->output("frame") >> fftc->input("frame");
+  //  cq->output("constantq") >> PC(pool, "cq");
+  //  *inputVec >> fc->input("signal");
+  cout << "-------- connecting algos --------" << endl;
+
+  //RMS
+  //  ringIn->output("signal") >> dcremoval->input("signal");
+
+  *inputVec >> algorithms["DCRemoval"]->input("signal");
+  // hand the buffer over a frame at a time, DCRemoval alone would have the
+  // scheduler step through it one sample per pass
+  inputVec->setAcquireSize(frameSize);
+
+  algorithms["DCRemoval"]->output("signal") >> algorithms["FrameCutter"]->input("signal");
+
+  // the windowed frames and their magnitude spectrum come from the sliding
+  // MLTKSlidingSpectrum, the fused MLTKSpectrum or the separate Essentia
+  // algorithms
+  SourceBase *windowed, *spectrum, *magnitudes, *phases;
+  if(slidingSpectrum){
+    algorithms["FrameCutter"]->output("frame") >> algorithms["Windowing"]->input("frame");
+    algorithms["FrameCutter"]->output("frame") >> algorithms["MLTKSlidingSpectrum"]->input("frame");
+    windowed = &algorithms["Windowing"]->output("frame");
+    spectrum = &algorithms["MLTKSlidingSpectrum"]->output("spectrum");
+    magnitudes = &algorithms["MLTKSlidingSpectrum"]->output("spectrum");
+    phases = &algorithms["MLTKSlidingSpectrum"]->output("phase");
+  } else if(fusedFrontEnd){
+    algorithms["FrameCutter"]->output("frame") >> algorithms["MLTKSpectrum"]->input("frame");
+    windowed = &algorithms["MLTKSpectrum"]->output("frame");
+    spectrum = &algorithms["MLTKSpectrum"]->output("spectrum");
+    magnitudes = &algorithms["MLTKSpectrum"]->output("spectrum");
+    phases = &algorithms["MLTKSpectrum"]->output("phase");
+    // the separate path has no power spectrum, keep the pool keys the same
+    algorithms["MLTKSpectrum"]->output("power") >> NOWHERE;
+  } else {
+    algorithms["FrameCutter"]->output("frame") >> algorithms["Windowing"]->input("frame");
+
+    algorithms["Windowing"]->output("frame") >> algorithms["FFT"]->input("frame");
+    algorithms["Windowing"]->output("frame") >> algorithms["Spectrum"]->input("frame");
+    algorithms["FFT"]->output("fft") >> algorithms["CartesianToPolar"]->input("complex");
+    windowed = &algorithms["Windowing"]->output("frame");
+    spectrum = &algorithms["Spectrum"]->output("spectrum");
+    magnitudes = &algorithms["CartesianToPolar"]->output("magnitude");
+    phases = &algorithms["CartesianToPolar"]->output("phase");
+  }
+
+  //  cout << "Connecting RMS" << endl;
+
+  *windowed >> algorithms["RMS"]->input("array");
+
+  // LargeFrameCutter only feeds the legacy LPC and Chromagram/SpectrumCQ
+  // branches
+  const bool largeFrames = !incrementalLPC || !multiResolutionCQ;
+  if(largeFrames){
+    *inputVec >> algorithms["LargeFrameCutter"]->input("signal");
+  }
+  //  fc2->output("frame") >> w2->input("frame");
+  SourceBase *lpc, *reflection;
+  if(incrementalLPC){
+    algorithms["FrameCutter"]->output("frame") >> algorithms["MLTKLPC"]->input("frame");
+    lpc = &algorithms["MLTKLPC"]->output("lpc");
+    reflection = &algorithms["MLTKLPC"]->output("reflection");
+  } else {
+    algorithms["LargeFrameCutter"]->output("frame") >> algorithms["LPC"]->input("frame");
+    lpc = &algorithms["LPC"]->output("lpc");
+    reflection = &algorithms["LPC"]->output("reflection");
+  }
+  //  w2->output("frame") >> fft2->input("frame");
+  SourceBase *chromagram, *spectrumCQ;
+  if(multiResolutionCQ){
+    algorithms["FrameCutter"]->output("frame") >> algorithms["MLTKConstantQ"]->input("frame");
+    chromagram = &algorithms["MLTKConstantQ"]->output("chromagram");
+    spectrumCQ = &algorithms["MLTKConstantQ"]->output("spectrumCQ");
+    *spectrumCQ >> algorithms["MLTKNNLSChroma"]->input("spectrumCQ");
+  } else {
+    algorithms["LargeFrameCutter"]->output("frame") >> algorithms["LargeWindowing"]->input("frame");
+    algorithms["LargeWindowing"]->output("frame") >> algorithms["Chromagram"]->input("frame");
+    algorithms["LargeWindowing"]->output("frame") >> algorithms["SpectrumCQ"]->input("frame");
+    chromagram = &algorithms["Chromagram"]->output("chromagram");
+    spectrumCQ = &algorithms["SpectrumCQ"]->output("spectrumCQ");
+  }
+  // MFCC, BFCC and GFCC -- mel, bark and gammatone cepstrum coefficients,
+  // either in one pass or from the separate Essentia algorithms
+  SourceBase *mfcc, *mfccBands, *bfcc, *bfccBands, *gfcc, *gfccBands;
+  if(fusedCepstrum){
+    *spectrum >> algorithms["MLTKCepstrum"]->input("spectrum");
+    mfcc = &algorithms["MLTKCepstrum"]->output("mfcc");
+    mfccBands = &algorithms["MLTKCepstrum"]->output("mfccBands");
+    bfcc = &algorithms["MLTKCepstrum"]->output("bfcc");
+    bfccBands = &algorithms["MLTKCepstrum"]->output("bfccBands");
+    gfcc = &algorithms["MLTKCepstrum"]->output("gfcc");
+    gfccBands = &algorithms["MLTKCepstrum"]->output("gfccBands");
+  } else {
+    *spectrum >> algorithms["GFCC"]->input("spectrum");
+    *spectrum >> algorithms["BFCC"]->input("spectrum");
+    *spectrum >> algorithms["MFCC"]->input("spectrum");
+    mfcc = &algorithms["MFCC"]->output("mfcc");
+    mfccBands = &algorithms["MFCC"]->output("bands");
+    bfcc = &algorithms["BFCC"]->output("bfcc");
+    bfccBands = &algorithms["BFCC"]->output("bands");
+    gfcc = &algorithms["GFCC"]->output("gfcc");
+    gfccBands = &algorithms["GFCC"]->output("bands");
+  }
+  //    cout << 9 << endl;
+  *spectrum >> algorithms["SpectralPeaks"]->input("spectrum");
+  *spectrum >> algorithms["MLTKNovelty"]->input("spectrum");
+  algorithms["MLTKNovelty"]->output("novelty") >> algorithms["MLTKOnsetDetector"]->input("novelty");
+  algorithms["FrameCutter"]->output("frame") >> algorithms["MLTKOnsetDetector"]->input("frame");
+  //    cout << 10 << endl;
+  algorithms["SpectralPeaks"]->output("frequencies") >> algorithms["HPCP"]->input("frequencies");
+  //    cout << 11 << endl;
+  algorithms["SpectralPeaks"]->output("magnitudes") >> algorithms["HPCP"]->input("magnitudes");
+  // the optional streaming descriptors, see beatTracking and the flags
+  // after it
+  if(beatTracking){
+    algorithms["MLTKNovelty"]->output("novelty") >> algorithms["MLTKBeatTracker"]->input("novelty");
+  }
+  if(tonal){
+    algorithms["HPCP"]->output("hpcp") >> algorithms["MLTKTonal"]->input("hpcp");
+  }
+  if(loudness){
+    algorithms["FrameCutter"]->output("frame") >> algorithms["MLTKLoudness"]->input("frame");
+  }
+  if(yinPitch){
+    algorithms["FrameCutter"]->output("frame") >> algorithms["MLTKPitchYin"]->input("frame");
+  }
+  if(segmenter){
+    algorithms["HPCP"]->output("hpcp") >> algorithms["MLTKSegmenter"]->input("chroma");
+    *mfcc >> algorithms["MLTKSegmenter"]->input("mfcc");
+  }
+  if(melody){
+    algorithms["SpectralPeaks"]->output("frequencies") >> algorithms["MLTKMelody"]->input("frequencies");
+    algorithms["SpectralPeaks"]->output("magnitudes") >> algorithms["MLTKMelody"]->input("magnitudes");
+  }
+  if(qualityMonitor){
+    algorithms["FrameCutter"]->output("frame") >> algorithms["MLTKQCMonitor"]->input("frame");
+  }
+  // sines found by SineModelAnal and the rest of the spectrum, remixed and
+  // resynthesized into outputRing
+  if(resynthesis){
+    if(slidingSpectrum || fusedFrontEnd){
+      *windowed >> algorithms["FFT"]->input("frame");
+    }
+    algorithms["FFT"]->output("fft") >> algorithms["SineModelAnal"]->input("fft");
+    algorithms["FFT"]->output("fft") >> algorithms["MLTKHarmonicRemix"]->input("fft");
+    algorithms["SineModelAnal"]->output("frequencies") >> algorithms["MLTKHarmonicRemix"]->input("frequencies");
+    // the remix scales the spectrum around the sines, their frequencies are
+    // all it needs
+    algorithms["SineModelAnal"]->output("magnitudes") >> NOWHERE;
+    algorithms["SineModelAnal"]->output("phases") >> NOWHERE;
+    algorithms["MLTKHarmonicRemix"]->output("fft") >> algorithms["IFFT"]->input("fft");
+    algorithms["IFFT"]->output("frame") >> algorithms["MLTKOverlapAdd"]->input("frame");
+  }
+  // Pool Outputs
+  *lpc >> PC(pool, "LPC.coefs");
+  *reflection >> PC(pool, "LPC.reflection");
+  algorithms["DCRemoval"]->output("signal") >> PC(pool, "DCRemoval");
+  algorithms["FrameCutter"]->output("frame") >> PC(pool, "FrameCutter");
+  if(largeFrames){
+    algorithms["LargeFrameCutter"]->output("frame") >> PC(pool, "LargeFrameCutter");
+  }
+  *windowed >> PC(pool, "Windowing");
+  algorithms["RMS"]->output("rms") >> PC(pool, "RMS");
+  //  fft->output("fft") >> PC(pool, "fft");
+  *spectrum >> PC(pool, "Spectrum");
+  *spectrumCQ >> PC(pool, "SpectrumCQ");
+  *bfccBands >> PC(pool, "BFCC.bands");
+  *bfcc >> PC(pool, "BFCC.coefs");
+  *gfccBands >> PC(pool, "GFCC.bands");
+  *gfcc >> PC(pool, "GFCC.coefs");
+  *mfccBands >> PC(pool, "MFCC.bands");
+  *mfcc >> PC(pool, "MFCC.coefs");
+  algorithms["HPCP"]->output("hpcp") >> PC(pool, "HPCP");
+  //  *inputVec >> algorithms["CubicSpline"]->input("x");
+
+  //  algorithms["CubicSpline"]->output("y") >> PC(pool, "CubicSpline.y");
+  //  algorithms["CubicSpline"]->output("dy") >> PC(pool, "CubicSpline.dy");;
+  //  algorithms["CubicSpline"]->output("ddy") >> PC(pool, "CubicSpline.ddy");;
+  *magnitudes >> PC(pool, "Magnitudes");
+  *phases >> PC(pool, "Phases");
+  *chromagram >> PC(pool, "Chromagram");
+  algorithms["MLTKNovelty"]->output("novelty") >> PC(pool, "Novelty");
+  algorithms["MLTKOnsetDetector"]->output("onset") >> PC(pool, "Onset");
+  if(beatTracking){
+    algorithms["MLTKBeatTracker"]->output("bpm") >> PC(pool, "BeatTracker.bpm");
+    algorithms["MLTKBeatTracker"]->output("beat") >> PC(pool, "BeatTracker.beat");
+  }
+  if(tonal){
+    algorithms["MLTKTonal"]->output("key") >> PC(pool, "Tonal.key");
+    algorithms["MLTKTonal"]->output("scale") >> PC(pool, "Tonal.scale");
+    algorithms["MLTKTonal"]->output("keyStrength") >> PC(pool, "Tonal.keyStrength");
+    algorithms["MLTKTonal"]->output("chord") >> PC(pool, "Tonal.chord");
+    algorithms["MLTKTonal"]->output("chordStrength") >> PC(pool, "Tonal.chordStrength");
+  }
+  if(loudness){
+    algorithms["MLTKLoudness"]->output("momentary") >> PC(pool, "Loudness.momentary");
+    algorithms["MLTKLoudness"]->output("shortTerm") >> PC(pool, "Loudness.shortTerm");
+    algorithms["MLTKLoudness"]->output("integrated") >> PC(pool, "Loudness.integrated");
+  }
+  if(yinPitch){
+    algorithms["MLTKPitchYin"]->output("pitch") >> PC(pool, "PitchYin.pitch");
+    algorithms["MLTKPitchYin"]->output("pitchConfidence") >> PC(pool, "PitchYin.confidence");
+  }
+  if(segmenter){
+    algorithms["MLTKSegmenter"]->output("novelty") >> PC(pool, "Segmenter.novelty");
+    algorithms["MLTKSegmenter"]->output("boundary") >> PC(pool, "Segmenter.boundary");
+  }
+  if(melody){
+    algorithms["MLTKMelody"]->output("pitch") >> PC(pool, "Melody.pitch");
+    algorithms["MLTKMelody"]->output("pitchConfidence") >> PC(pool, "Melody.confidence");
+  }
+  if(multiResolutionCQ){
+    algorithms["MLTKConstantQ"]->output("hpcp") >> PC(pool, "HPCPCQ");
+    algorithms["MLTKNNLSChroma"]->output("chroma") >> PC(pool, "NNLSChroma.chroma");
+    algorithms["MLTKNNLSChroma"]->output("bassChroma") >> PC(pool, "NNLSChroma.bass");
+  }
+  if(qualityMonitor){
+    algorithms["MLTKQCMonitor"]->output("cpu") >> PC(pool, "QC.cpu");
+    algorithms["MLTKQCMonitor"]->output("active") >> PC(pool, "QC.active");
+  }
+}
+
+void MLTKCore::connectAlgorithmStream(essentia::streaming::AlgorithmFactory& factory){
+  std::cout << "-------- connecting algorithm stream --------" << std::endl;
+  
+  // We start with the incoming signal that was attached to inputVec
+  *inputVec >> algorithms["FrameCutter"]->input("signal");
+  //algorithms["DCRemoval"]->input("signal");
+
+
+  // Remember that all the strings match 1:1 with Essentia's reference documentation.
+  // Algorithms can have an unlimited number of OUTPUTS but every input must
+  // always have exactly 1 connection.
+  // (tl;dr; inputs always need to be connected)
+//  algorithms["DCRemoval"]->output("signal") >>
+//  *inputVec >> algorithms["LargeFrameCutter"]->input("signal");
+  algorithms["FrameCutter"]->output("frame") >> algorithms["Windowing"]->input("frame");
+  algorithms["Windowing"]->output("frame") >> algorithms["RMS"]->input("array");
+  algorithms["Windowing"]->output("frame") >> algorithms["Spectrum"]->input("frame");
+    //  algorithms["Windowing"]->output("frame") >> algorithms["Chromagram"]->input("frame");
+  algorithms["Spectrum"]->output("spectrum")  >> algorithms["MFCC"]->input("spectrum");
+  algorithms["Spectrum"]->output("spectrum") >> algorithms["SpectralPeaks"]->input("spectrum");
+  algorithms["SpectralPeaks"]->output("frequencies") >> algorithms["HPCP"]->input("frequencies");
+  algorithms["SpectralPeaks"]->output("magnitudes") >> algorithms["HPCP"]->input("magnitudes");
+  
+//  *inputVec >> algorithms["BeatsLoudness"]->input("signal");
+//  algorithms["BeatsLoudness"]->output("loudness") >> algorithms["Beatogram"]->input("loudness");
+//  algorithms["BeatsLoudness"]->output("loudnessBandRatio") >> algorithms["Beatogram"]->input("loudnessBandRatio");
+  
+  // Pool Outputs
+  algorithms["DCRemoval"]->output("signal") >> PC(pool, "DCRemoval");
+  algorithms["FrameCutter"]->output("frame") >> PC(pool, "FrameCutter");
+  algorithms["Windowing"]->output("frame") >> PC(pool, "Windowing");
+  algorithms["RMS"]->output("rms") >> PC(pool, "RMS");
+  algorithms["Spectrum"]->output("spectrum")  >>  PC(pool, "Spectrum");
+  algorithms["MFCC"]->output("mfcc") >> PC(pool, "MFCC.coefs");
+  algorithms["MFCC"]->output("bands") >> PC(pool, "MFCC.bands");
+  algorithms["HPCP"]->output("hpcp") >> PC(pool, "HPCP");
+}
+
+// the newest token of every key in one of a pool's maps
+template <typename T>
+static void addNewest(Pool &to, const PoolOf(T) &from){
+  for(auto &k : from){
+    if(!k.second.empty()) to.add(k.first, k.second.back());
+  }
+}
+
+void MLTKCore::setup(int frameSize, int sampleRate, int hopSize, bool useDefaultAlgorithms){
+  this->frameSize = frameSize;
+  this->sampleRate = sampleRate;
+  this->hopSize = hopSize;
+
+  setupNetwork(useDefaultAlgorithms);
+}
+
+void MLTKCore::setupNetwork(bool useDefaultAlgorithms){
+  audioBuffer.resize(frameSize, 0.0);
+
+  // the overlap buffer holds the newest frame plus the hops that can be
+  // pending between two calls to run()
+  inputRing.setup(frameSize + maxFramesPerRun * hopSize);
+  framesAnalyzed = 0;
+
+  // shared with every other MLTK instance, the first one initialises
+  // Essentia and the last one to exit shuts it down
+  if(!acquired) MLTKEngine::acquire();
+  acquired = true;
+
+  // wisdom is process-wide, it also speeds up the plans Essentia's own FFT
+  // algorithms make
+  if(fftWisdom.length() > 0 && !MLTKFFT::loadWisdom(fftWisdom)){
+    cerr << "MLTK: could not read FFTW wisdom from " << fftWisdom << endl;
+  }
+
+  essentia::streaming::AlgorithmFactory& f = essentia::streaming::AlgorithmFactory::instance();
+  setupAlgorithms(f);
+
+  if(useDefaultAlgorithms){
+    connectDefaultAlgorithmStream(f);
+  } else {
+    connectAlgorithmStream(f);
+  }
+
+  // the stateful algorithms post to this instance's event queue
+  stateful.clear();
+  for(auto &a : algorithms){
+    MLTKStatefulAlgorithm *algorithm = dynamic_cast<MLTKStatefulAlgorithm*>(a.second);
+    if(algorithm == NULL) continue;
+    algorithm->setEventQueue(&events);
+    stateful.push_back(algorithm);
+  }
+
+  // the resynthesis lands latency samples after the input, the ring holds
+  // that plus the frames a run can write ahead
+  if(resynthesis){
+    const int latency = outputLatency > 0 ? outputLatency : 2 * frameSize;
+    outputRing.setup(latency + frameSize + (maxFramesPerRun + 1) * hopSize, latency);
+    static_cast<MLTKOverlapAdd*>(algorithms["MLTKOverlapAdd"])->setOutput(&outputRing);
+  }
+
+  // the factory stays alive until exit(), the timeline's workers keep
+  // creating algorithms from it in the background
+  network = new scheduler::Network(inputVec);
+  network->run();
+
+  // the run above only primed the network with silence, which is also what
+  // the silence gate publishes: one hop of it, the newest frame of every
+  // key and a hop of the streams that have a token per sample (DCRemoval)
+  clearState();
+  silentPool.clear();
+  for(auto &k : pool.getRealPool()){
+    if(k.second.empty()) continue;
+    const int tokens = k.second.size() == audioBuffer.size() ? hopSize : 1;
+    for(int i = 0; i < tokens; i++) silentPool.add(k.first, k.second.back());
+  }
+  addNewest<vector<Real> >(silentPool, pool.getVectorRealPool());
+  addNewest<string>(silentPool, pool.getStringPool());
+  addNewest<vector<string> >(silentPool, pool.getVectorStringPool());
+  addNewest<TNT::Array2D<Real> >(silentPool, pool.getArray2DRealPool());
+  outputRing.clear();
+  silent = false;
+  quietSamples = 0;
+  skippedFrames = 0;
+  framesSkipped = 0;
+
+  if(precompute && fileName.length() > 0){
+    timeline.sampleRate = sampleRate;
+    timeline.frameSize = frameSize;
+    timeline.hopSize = hopSize;
+    timeline.setup(fileName);
+  }
+
+  // the minMaxMap provides a way of dynamically scaling
+  // the values for different algorithms. This initializes
+  // the minimums and maximums at their limits. These values
+  // will get updated at runtime.
+
+  for(std::map<string,Algorithm*>::iterator iter = algorithms.begin(); iter != algorithms.end(); ++iter) {
+    string k = iter->first;
+
+    // minimum
+    minMaxMap[k][0] = 1000.0;
+    // maximum
+    minMaxMap[k][1] = -1000.0;
+
+    //ignore value
+    //Value v = iter->second;
+  }
+}
+
+void MLTKCore::audioIn(const float *input, int numFrames, int numChannels){
+  inputRing.write(input, numFrames, numChannels);
+}
+
+void MLTKCore::audioOut(float *output, int numFrames, int numChannels){
+  outputRing.read(output, numFrames, numChannels);
+}
+
+void MLTKCore::setPlayhead(float seconds){
+  playhead = seconds;
+  timeline.setPlayhead(seconds);
+}
+
+void MLTKCore::run(){
+  // the timeline already holds every frame, nothing to compute
+  if(precompute && fileName.length() > 0) return;
+
+  // nothing new since the last call, keep the newest frame in the pool
+  if(!update()) return;
+
+  std::lock_guard<std::mutex> lock(poolMutex);
+  if(!accumulating) pool.clear();
+
+  const int frames = (audioBuffer.size() - frameSize) / hopSize + 1;
+  if(silenceGate && gate(frames)){
+    for(int i = 0; i < frames; i++){
+      pool.merge(silentPool, "append");
+    }
+    framesSkipped += frames;
+    skippedFrames += frames;
+    // the resynthesis of silence is silence
+    if(resynthesis){
+      outputRing.commit(runStart + (unsigned long long) frames * hopSize);
+    }
+  } else {
+    // the stateful algorithms only take the newest hop of each frame, after
+    // a gap they have to start over, after silence they can skip ahead
+    if(dropped){
+      clearState();
+      dropped = false;
+    } else if(skippedFrames > 0){
+      for(MLTKStatefulAlgorithm *algorithm : stateful){
+        algorithm->skipFrames(skippedFrames);
+      }
+    }
+    skippedFrames = 0;
+    for(MLTKStatefulAlgorithm *algorithm : stateful){
+      algorithm->setPosition(runStart);
+    }
+    if(resynthesis){
+      static_cast<MLTKHarmonicRemix*>(algorithms["MLTKHarmonicRemix"])->setGains(harmonicGain, noiseGain);
+    }
+
+    network->reset();
+    network->run();
+  }
+  
+  if(recording){
+    aggr->input("input").set(pool);
+    aggr->output("output").set(poolAggr);
+    
+    aggr->compute();
+  }
+}
+
+void MLTKCore::clearState(){
+  for(MLTKStatefulAlgorithm *algorithm : stateful){
+    algorithm->clear();
+  }
+}
+
+bool MLTKCore::gate(int frames){
+  // the samples the frames of this run add
+  const int count = min((int) audioBuffer.size(), frames * hopSize);
+  double energy = 0;
+  for(int i = audioBuffer.size() - count; i < (int) audioBuffer.size(); i++){
+    energy += audioBuffer[i] * audioBuffer[i];
+  }
+  const Real level = 10 * log10(energy / max(1, count) + 1e-20);
+
+  if(silent){
+    if(level > silenceThreshold + silenceHysteresis){
+      silent = false;
+      quietSamples = 0;
+    }
+  } else if(level < silenceThreshold){
+    quietSamples += count;
+    silent = quietSamples >= silenceHold * sampleRate;
+  } else {
+    quietSamples = 0;
+  }
+  return silent;
+}
+
+bool MLTKCore::isSilent(){
+  return silent;
+}
+
+bool MLTKCore::pending(){
+  const unsigned long long written = inputRing.getWritten();
+  if(written < (unsigned long long) frameSize) return false;
+  return (written - frameSize) / hopSize + 1 > framesAnalyzed;
+}
+
+template <class mType>
+bool MLTKCore::exists(string algorithm){
+  return pool.contains<mType>(algorithm);
+};
+
+vector<float> MLTKCore::getMeanData(string algorithm){
+  std::lock_guard<std::mutex> lock(poolMutex);
+  return meanFrames(pool.value<vector<vector<Real>>>(algorithm));
+};
+
+// Returns the newest complete frame
+vector<float> MLTKCore::getData(string algorithm){
+  if(precompute && fileName.length() > 0){
+    return timeline.getData(algorithm, playhead);
+  }
+  std::lock_guard<std::mutex> lock(poolMutex);
+  return pool.value<vector<vector<Real>>>(algorithm).back();
+};
+
+vector<vector<Real>> MLTKCore::getRaw(string algorithm){
+  std::lock_guard<std::mutex> lock(poolMutex);
+  return pool.value<vector<vector<Real>>>(algorithm);
+};
+
+Real MLTKCore::getValue(string algorithm){
+  if(precompute && fileName.length() > 0){
+    return timeline.getValue(algorithm, playhead);
+  }
+  std::lock_guard<std::mutex> lock(poolMutex);
+  Real val = pool.value<vector<Real>>(algorithm).back();
+  return val;
+};
+
+// Fills audioBuffer with the samples the next network run should analyse.
+// Returns false when no new hop has completed since the last call.
+bool MLTKCore::update(){
+  unsigned long long n;
+  do {
+    const unsigned long long written = inputRing.getWritten();
+    if(written < (unsigned long long) frameSize) return false;
+
+    // frame n covers [n * hopSize, n * hopSize + frameSize)
+    const unsigned long long framesAvailable = (written - frameSize) / hopSize + 1;
+    if(framesAvailable <= framesAnalyzed) return false;
+
+    n = framesAvailable - framesAnalyzed;
+    if(n > (unsigned long long) maxFramesPerRun){
+      framesAnalyzed += n - maxFramesPerRun;
+      n = maxFramesPerRun;
+      dropped = true;
+    }
+
+    runStart = framesAnalyzed * hopSize;
+    audioBuffer.resize(frameSize + (n - 1) * hopSize);
+    // if the input callback lapped the oldest of these samples while they
+    // were copied, the newest hops are taken again
+  } while(!inputRing.read(runStart, audioBuffer.size(), &audioBuffer[0]));
+
+  framesAnalyzed += n;
+  return true;
+}
+
+void MLTKCore::save(){
+  output->input("pool").set(poolAggr);
+  output->compute();
+  
+    //  pool.clear();
+    //  network->reset();
+    //  network->run();
+}
+
+void MLTKCore::exit(){
+  timeline.stop();
+  if(network != NULL){
+    network->clear();
+  }
+  pool.clear();
+  poolAggr.clear();
+  if(acquired) MLTKEngine::release();
+  acquired = false;
+
+  // clearing the network already deleted inputVec and everything connected
+  // to it
+  delete aggr;
+  delete output;
+  delete network;
+  aggr = output = NULL;
+  network = NULL;
+}
@@ -0,0 +1,334 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef ofxMLTKCore_h
+#define ofxMLTKCore_h
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "algorithmfactory.h"
+#include "essentiamath.h"
+#include "pool.h"
+#include "streaming/streamingalgorithm.h"
+#include "streaming/algorithms/vectorinput.h"
+#include "streaming/algorithms/vectoroutput.h"
+#include "streaming/algorithms/ringbufferinput.h"
+#include "streaming/algorithms/ringbufferoutput.h"
+#include "streaming/algorithms/poolstorage.h"
+#include "streaming/algorithms/devnull.h"
+#include "streaming/accumulatoralgorithm.h"
+#include "scheduler/network.h"
+
+#include "ofxMLTKEngine.h"
+#include "ofxMLTKEvents.h"
+#include "ofxMLTKFFT.h"
+#include "ofxMLTKInputRing.h"
+#include "ofxMLTKOutputRing.h"
+#include "ofxMLTKTimeline.h"
+
+class MLTKStatefulAlgorithm;
+
+using namespace std;
+using namespace chrono;
+using namespace essentia;
+using namespace streaming;
+using namespace scheduler;
+
+// The analysis engine without any openFrameworks dependency: it builds the
+// algorithm registry and network, takes audio as plain interleaved float
+// buffers and holds the results in the pool. MLTK (ofxMLTK.h) adapts it to
+// ofSoundStream/ofSoundBuffer and adds drawing, while this class can run
+// headless in server-side workers and benchmarks.
+class MLTKCore {
+public:
+  virtual ~MLTKCore() {}
+
+  // This boolean is used to toggle the recording of data to an output
+  // file in the YAML format. YAML is a data format similar to JSON
+  bool recording = false;
+  
+  
+  
+  // This boolean controls whether the pool should accumulate values or
+  // be cleared on each frame
+  bool accumulating = false;
+  
+  // NOT CURRENTLY IMPLEMENTED
+  //  // !!!IMPORTANT!!! To setup your own Algorithm stream set customMode to true
+  //  // and implement setupCustomAlgorithms)() and connectUserAlgorithmStream().
+  //  // setupAlgorithms() and connectAlgorithmStream() can be used as references.
+  //  //  bool customMode = false;
+  // NOT CURRENTLY IMPLEMENTED
+  
+  // Not currently being used
+  // std::map<std::string, VectorInput<Real>> inputMap;
+  VectorInput<Real> *inputVec, *leftInputVec, *rightInputVec;
+  
+  VectorInput<Real> *inputX;
+  
+  // a vector for handling input containing complex values
+  //  VectorInput<std::complex<Real>> *complexInput;
+  //  VectorOutput<std::vector<std::complex<Real>>> *complexOutput;
+
+  // Ring buffer provided by essentia
+  //  essentia::streaming::RingBufferInput *ringIn;
+  //  essentia::streaming::RingBufferOutput *ringOut;
+  
+  // Pointer to the algorithm network
+  scheduler::Network *network=NULL;
+  
+  // Pool objects for collecting, aggregating, and holding statistics.
+  Pool pool, poolAggr, poolStats;
+
+  // Dispatch Table, planned for future
+  //  std::map<string, function<vector<Real>()>> db;
+  map<string, Algorithm*> algorithms;
+  
+  string fileName;
+
+  // When a fileName is set and precompute is true, the whole file is
+  // analysed in the background, faster than real-time, into a timeline.
+  // The getters then look the frame at the playhead up instead of running
+  // the real-time chain; the app calls setPlayhead() as playback moves.
+  bool precompute = false;
+  MLTKTimeline timeline;
+  float playhead = 0.0;
+  void setPlayhead(float seconds);
+  
+  int numberOfOutputChannels = 0;
+  int numberOfInputChannels = 2;
+  int sampleRate = 44100;
+  int frameSize = 2048;
+  int hopSize = frameSize/2;
+  int numberOfBuffers = 4;
+
+  // Overlap buffer decoupling the sound card's block size from the analysis
+  // frameSize/hopSize. audioIn() appends the (mono mixed) device blocks as
+  // they arrive and run() cuts every complete hop out of it, so 64 sample
+  // device blocks can feed 2048 sample analysis frames.
+  MLTKInputRing inputRing;
+  unsigned long long framesAnalyzed = 0;
+
+  // The default stream windows and transforms each frame with the fused
+  // MLTKSpectrum instead of Windowing -> Spectrum and FFT -> CartesianToPolar.
+  // The pool keys are the same either way.
+  bool fusedFrontEnd = true;
+
+  // Updates the magnitude spectrum and phases hop by hop with
+  // MLTKSlidingSpectrum instead of transforming every frame, and windows the
+  // frames for Windowing/RMS with Windowing. Pays off for small hops; takes
+  // precedence over fusedFrontEnd, the pool keys stay the same. Its window
+  // is periodic, the magnitudes are about 1.5 / frameSize (relative) off
+  // Windowing's symmetric one, see MLTKSlidingSpectrum.h.
+  bool slidingSpectrum = false;
+
+  // MFCC, BFCC and GFCC come out of one MLTKCepstrum, which applies all
+  // three filterbanks in a single sweep and shares the DCT between them.
+  bool fusedCepstrum = true;
+
+  // Chromagram and SpectrumCQ come from MLTKConstantQ, octave by octave on
+  // the regular frames, instead of 32768 sample LargeWindowing frames. It
+  // also adds an HPCP style profile as HPCPCQ, and NNLSChroma.chroma and
+  // NNLSChroma.bass on top of its spectrum.
+  bool multiResolutionCQ = true;
+
+  // LPC.coefs/LPC.reflection come from MLTKLPC every hop, over the same
+  // 32768 sample span as the LargeFrameCutter frames LPC used to get every
+  // 16384 samples
+  bool incrementalLPC = true;
+
+  // Onsets (MLTKNovelty -> MLTKOnsetDetector, Novelty and Onset) are always
+  // analysed. The other streaming descriptors are off until the app asks
+  // for them, each flag connects its algorithm and pool keys:
+
+  // BeatTracker.bpm and BeatTracker.beat, from the onset novelty
+  bool beatTracking = false;
+
+  // Tonal.key, Tonal.scale, Tonal.chord and their strengths, from HPCP
+  bool tonal = false;
+
+  // Loudness.momentary, Loudness.shortTerm and Loudness.integrated (EBU R128)
+  bool loudness = false;
+
+  // PitchYin.pitch and PitchYin.confidence
+  bool yinPitch = false;
+
+  // Segmenter.novelty and Segmenter.boundary, from HPCP and MFCC
+  bool segmenter = false;
+
+  // Melody.pitch and Melody.confidence, from the spectral peaks
+  bool melody = false;
+
+  // Runs Essentia's click, discontinuity, saturation, gap, noise burst,
+  // true peak and hum detectors on the default stream's frames (see
+  // MLTKQCMonitor) and posts what they find to events. QC.cpu holds the
+  // share of one core each detector takes, QC.active whether they ran.
+  bool qualityMonitor = false;
+
+  // Seconds NNLSChroma.* and Melody.* look ahead, they come out this much
+  // behind the other descriptors
+  float lookahead = 0.3;
+
+  // Resynthesizes the input into outputRing, to be played with audioOut():
+  // SineModelAnal finds the sinusoids, MLTKHarmonicRemix scales them by
+  // harmonicGain and the rest of the spectrum by noiseGain, and IFFT ->
+  // MLTKOverlapAdd turn it back into audio. The gains can be changed at any
+  // time, at 1 and 1 the output is the input.
+  bool resynthesis = false;
+  float harmonicGain = 1.0;
+  float noiseGain = 1.0;
+
+  // Samples between an input sample arriving in audioIn() and its
+  // resynthesis leaving audioOut(), 0 for 2 * frameSize. It has to cover a
+  // frame, the time between two run() calls and the device block size;
+  // outputRing.getUnderruns() counts the blocks it didn't.
+  int outputLatency = 0;
+  MLTKOutputRing outputRing;
+
+  // FFTW wisdom file loaded before the network is built, see MLTKFFT.
+  // Leave empty to plan from scratch.
+  string fftWisdom = "";
+
+  // Beats, onsets and other events posted by the stateful algorithms, with
+  // their position in the input stream. Pop them from the app's thread.
+  MLTKEventQueue events;
+
+  // Silence gate: once the input has stayed below silenceThreshold (RMS,
+  // dB) for silenceHold seconds, run() stops running the network and puts
+  // the descriptors of a silent frame in the pool for every hop instead. It
+  // opens again as soon as the level rises silenceHysteresis dB above the
+  // threshold, after the stateful algorithms have been brought past the
+  // skipped hops (MLTKStatefulAlgorithm::skipFrames()).
+  bool silenceGate = false;
+  float silenceThreshold = -60;
+  float silenceHysteresis = 6;
+  float silenceHold = 0.5;
+
+  // Hops the silence gate kept from the network since setup()
+  unsigned long long framesSkipped = 0;
+
+  // Upper bound on the number of hops analysed by a single call to run().
+  // If the app falls further behind than this, the oldest hops are dropped.
+  int maxFramesPerRun = 16;
+
+  // Held by run() while the network writes into the pool, the getters take
+  // it too so they can be called from another thread than run()
+  std::mutex poolMutex;
+
+  essentia::standard::Algorithm *aggr=NULL, *output=NULL;
+  
+  std::vector<Real> audioBuffer;
+
+  std::vector<Real> smoothInput;
+  
+  int binsPerOctave = 12;
+  
+  template <class mType>
+  bool exists(string algorithm);
+  
+  Real getValue(string algorithm);
+  Real getMeanValue(string algorithm);
+  vector<Real> getData(string algorithm);
+  vector<Real> getMeanData(string algorithm);
+  vector<vector<Real>> getRaw(string algorithm);
+
+  void setup(int frameSize=2048, int sampleRate=44100, int hopSize=1024, bool useDefaultAlgorithms=true);
+
+  // Builds the algorithm registry, connects the chain and starts the network
+  virtual void setupNetwork(bool useDefaultAlgorithms);
+
+  // Feeds the overlap buffer with interleaved samples, lock-free and safe
+  // to call from the audio thread
+  void audioIn(const float *input, int numFrames, int numChannels);
+
+  // Fills an interleaved output buffer with the resynthesis (silence
+  // without it), safe to call from the audio thread
+  void audioOut(float *output, int numFrames, int numChannels);
+
+  // Loads most of Essentia's streaming algorithms into the algorithm registry
+  virtual void setupAlgorithms(essentia::streaming::AlgorithmFactory& factory);
+
+  // Connects a user-defined algorithm chain
+  virtual void connectAlgorithmStream(essentia::streaming::AlgorithmFactory& factory);
+
+  // Connects a default algorithm chain
+  virtual void connectDefaultAlgorithmStream(essentia::streaming::AlgorithmFactory& factory);
+
+  template <typename... Params>
+  void create(map<string, Algorithm*> &m, essentia::streaming::AlgorithmFactory& f, string algo, Params... params);
+
+  map<string, float[2]> minMaxMap;
+
+  virtual bool update();
+
+  // Whether a hop completed since the last run()
+  bool pending();
+  void run();
+
+  // Makes the stateful algorithms (MLTKStatefulAlgorithm) forget their
+  // history, run() calls it when hops were dropped
+  void clearState();
+
+  // Whether the silence gate is closed
+  bool isSilent();
+  void save();
+  
+  void exit();
+
+protected:
+  bool acquired = false;
+
+  // update() dropped hops, the next run() starts from a clear state
+  bool dropped = false;
+
+  // stream position of the first frame update() handed to the network
+  unsigned long long runStart = 0;
+
+  // the MLTKStatefulAlgorithm instances in the registry
+  vector<MLTKStatefulAlgorithm*> stateful;
+
+  // one hop of the pool the network fills from silence, published for
+  // every hop the silence gate keeps from the network
+  Pool silentPool;
+  bool silent = false;
+
+  // samples below silenceThreshold in a row, and hops skipped since the
+  // network last ran
+  unsigned long long quietSamples = 0;
+  int skippedFrames = 0;
+
+  // Updates the silence gate with the new samples of the next run
+  bool gate(int frames);
+};
+
+#endif /* ofxMLTKCore_h */
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "ofxMLTKEngine.h"
+#include "ofxMLTKCore.h"
+
+#include <algorithm>
+#include <ctime>
+
+static std::mutex runtimeMutex;
+static int runtimeUsers = 0;
+static bool runtimeOwned = false;
+
+// CPU time of the calling thread, so time a worker spends preempted isn't
+// charged to the instance it is running
+static double threadCPUTime(){
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void MLTKEngine::acquire(){
+  std::lock_guard<std::mutex> lock(runtimeMutex);
+  if(runtimeUsers++ == 0 && !essentia::isInitialized()){
+    essentia::init();
+    runtimeOwned = true;
+  }
+}
+
+void MLTKEngine::release(){
+  std::lock_guard<std::mutex> lock(runtimeMutex);
+  if(runtimeUsers == 0) return;
+  if(--runtimeUsers == 0 && runtimeOwned){
+    essentia::shutdown();
+    runtimeOwned = false;
+  }
+}
+
+MLTKEngine::~MLTKEngine(){
+  stop();
+  for(unique_ptr<Instance> &i : instances){
+    if(i->owned){
+      i->core->exit();
+      delete i->core;
+    }
+  }
+}
+
+MLTKCore* MLTKEngine::add(int frameSize, int sampleRate, int hopSize, float cpuBudget, bool useDefaultAlgorithms){
+  MLTKCore *core = new MLTKCore();
+  core->setup(frameSize, sampleRate, hopSize, useDefaultAlgorithms);
+  add(core, cpuBudget);
+  find(core)->owned = true;
+  return core;
+}
+
+void MLTKEngine::add(MLTKCore *core, float cpuBudget){
+  unique_ptr<Instance> i(new Instance());
+  i->core = core;
+  i->owned = false;
+  i->budget = cpuBudget;
+  i->credit = cpuBudget * burst;
+  i->lastCredit = i->windowStart = chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> lock(instanceMutex);
+  instances.push_back(std::move(i));
+}
+
+void MLTKEngine::remove(MLTKCore *core){
+  unique_ptr<Instance> removed;
+  {
+    std::unique_lock<std::mutex> lock(instanceMutex);
+    for(size_t n = 0; n < instances.size(); n++){
+      if(instances[n]->core != core) continue;
+      idle.wait(lock, [&](){ return !instances[n]->busy; });
+      removed = std::move(instances[n]);
+      instances.erase(instances.begin() + n);
+      if(nextInstance > n) nextInstance--;
+      break;
+    }
+  }
+
+  if(removed && removed->owned){
+    removed->core->exit();
+    delete removed->core;
+  }
+}
+
+void MLTKEngine::setBudget(MLTKCore *core, float cpuBudget){
+  std::lock_guard<std::mutex> lock(instanceMutex);
+  Instance *i = find(core);
+  if(i) i->budget = cpuBudget;
+}
+
+void MLTKEngine::start(){
+  stop();
+
+  int n = numberOfThreads > 0 ? numberOfThreads : (int) std::thread::hardware_concurrency();
+  if(n < 1) n = 1;
+
+  stopping = false;
+  for(int i = 0; i < n; i++){
+    workers.push_back(std::thread(&MLTKEngine::worker, this));
+  }
+}
+
+void MLTKEngine::stop(){
+  stopping = true;
+  wake.notify_all();
+  for(std::thread &t : workers){
+    t.join();
+  }
+  workers.clear();
+}
+
+void MLTKEngine::audioIn(MLTKCore *core, const float *input, int numFrames, int numChannels){
+  core->audioIn(input, numFrames, numChannels);
+  wake.notify_one();
+}
+
+float MLTKEngine::getLoad(MLTKCore *core){
+  std::lock_guard<std::mutex> lock(instanceMutex);
+  Instance *i = find(core);
+  return i ? i->load : 0.0;
+}
+
+unsigned long long MLTKEngine::getThrottled(MLTKCore *core){
+  std::lock_guard<std::mutex> lock(instanceMutex);
+  Instance *i = find(core);
+  return i ? i->throttleCount : 0;
+}
+
+unsigned long long MLTKEngine::getFailed(MLTKCore *core){
+  std::lock_guard<std::mutex> lock(instanceMutex);
+  Instance *i = find(core);
+  return i ? i->failCount : 0;
+}
+
+MLTKEngine::Instance* MLTKEngine::find(MLTKCore *core){
+  for(unique_ptr<Instance> &i : instances){
+    if(i->core == core) return i.get();
+  }
+  return NULL;
+}
+
+// The next idle instance with a hop waiting and CPU time left, round robin
+// so every stream gets its turn. Called with instanceMutex held.
+MLTKEngine::Instance* MLTKEngine::next(){
+  chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+  for(size_t n = 0; n < instances.size(); n++){
+    Instance *i = instances[(nextInstance + n) % instances.size()].get();
+
+    double elapsed = chrono::duration<double>(now - i->windowStart).count();
+    if(elapsed >= 1.0){
+      i->load = i->windowCPU / elapsed;
+      i->windowCPU = 0;
+      i->windowStart = now;
+    }
+
+    if(i->budget > 0){
+      double earned = chrono::duration<double>(now - i->lastCredit).count() * i->budget;
+      i->credit = min(i->credit + earned, (double) i->budget * burst);
+    }
+    i->lastCredit = now;
+
+    if(i->busy || !i->core->pending()) continue;
+
+    if(i->budget > 0 && i->credit <= 0){
+      // counted once per stretch of debt, not once per look
+      if(!i->throttled) i->throttleCount++;
+      i->throttled = true;
+      continue;
+    }
+    i->throttled = false;
+
+    nextInstance = (nextInstance + n + 1) % instances.size();
+    return i;
+  }
+  return NULL;
+}
+
+void MLTKEngine::worker(){
+  while(!stopping){
+    Instance *i;
+    {
+      std::unique_lock<std::mutex> lock(instanceMutex);
+      i = next();
+      if(i == NULL){
+        // audioIn() wakes us up, the timeout covers instances fed directly
+        // and budgets that recover over time
+        wake.wait_for(lock, chrono::milliseconds(2));
+        continue;
+      }
+      i->busy = true;
+    }
+
+    double start = threadCPUTime();
+    bool failed = false;
+    try {
+      i->core->run();
+    } catch (std::exception &e) {
+      cerr << "MLTKEngine: " << e.what() << endl;
+      failed = true;
+    }
+    double used = threadCPUTime() - start;
+
+    {
+      std::lock_guard<std::mutex> lock(instanceMutex);
+      i->busy = false;
+      if(failed) i->failCount++;
+      i->credit -= used;
+      i->windowCPU += used;
+    }
+    idle.notify_all();
+  }
+}
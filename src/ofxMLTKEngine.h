@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef ofxMLTKEngine_h
+#define ofxMLTKEngine_h
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class MLTKCore;
+
+// Runs many independent MLTK analysis instances (one per stream, room, ...)
+// on a shared thread pool.
+//
+// Essentia's global state is reference counted through acquire()/release(),
+// which every MLTK class uses instead of calling essentia::init() and
+// shutdown() directly, so instances can come and go in any order.
+//
+// Each worker picks the next instance, round robin, that has a complete hop
+// waiting and runs its network. An instance is never run on two workers at
+// once. Instances with a CPU budget earn CPU time at that rate (a fraction
+// of one core) and are held back while they are in debt, so an expensive
+// stream falls behind and drops its oldest hops (see maxFramesPerRun)
+// instead of starving the others.
+class MLTKEngine {
+public:
+  // 0 uses one worker per hardware thread
+  int numberOfThreads = 0;
+
+  // Seconds of CPU time an instance can save up while idle, as a multiple
+  // of its budget
+  float burst = 0.5;
+
+  ~MLTKEngine();
+
+  // Reference counted essentia::init() / essentia::shutdown()
+  static void acquire();
+  static void release();
+
+  // Creates an instance, the engine owns it and deletes it on remove() or
+  // when the engine is destroyed. cpuBudget is a fraction of one core, 0
+  // leaves it unlimited.
+  MLTKCore* add(int frameSize=2048, int sampleRate=44100, int hopSize=1024, float cpuBudget=0, bool useDefaultAlgorithms=true);
+
+  // Hosts an instance that was already set up (a subclass with its own
+  // chain, for example). The caller keeps ownership.
+  void add(MLTKCore *instance, float cpuBudget=0);
+
+  // Waits for the instance to finish its current run and stops hosting it
+  void remove(MLTKCore *instance);
+
+  void setBudget(MLTKCore *instance, float cpuBudget);
+
+  void start();
+  void stop();
+
+  // Feeds an instance and wakes a worker up for it, safe to call from the
+  // audio thread
+  void audioIn(MLTKCore *instance, const float *input, int numFrames, int numChannels);
+
+  // Fraction of one core the instance used over the last second
+  float getLoad(MLTKCore *instance);
+
+  // Number of times the instance had a hop waiting but was over budget
+  unsigned long long getThrottled(MLTKCore *instance);
+
+  // Number of runs of the instance that threw
+  unsigned long long getFailed(MLTKCore *instance);
+
+protected:
+  struct Instance {
+    MLTKCore *core;
+    bool owned;
+    float budget;
+    double credit;
+    chrono::steady_clock::time_point lastCredit;
+    bool busy = false;
+    bool throttled = false;
+    unsigned long long throttleCount = 0;
+    unsigned long long failCount = 0;
+
+    // CPU time over the current and the last finished one second window
+    double windowCPU = 0;
+    chrono::steady_clock::time_point windowStart;
+    float load = 0;
+  };
+
+  vector<unique_ptr<Instance> > instances;
+  size_t nextInstance = 0;
+  std::mutex instanceMutex;
+  std::condition_variable wake, idle;
+
+  vector<std::thread> workers;
+  atomic<bool> stopping{false};
+
+  Instance* find(MLTKCore *core);
+  Instance* next();
+  void worker();
+};
+
+#endif /* ofxMLTKEngine_h */
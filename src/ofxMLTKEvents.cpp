@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "ofxMLTKEvents.h"
+
+MLTKEventQueue::MLTKEventQueue(size_t capacity) : events(capacity + 1) {
+}
+
+bool MLTKEventQueue::push(const MLTKEvent &event){
+  const size_t t = tail.load(memory_order_relaxed);
+  const size_t next = (t + 1) % events.size();
+  if(next == head.load(memory_order_acquire)){
+    dropped++;
+    return false;
+  }
+  events[t] = event;
+  tail.store(next, memory_order_release);
+  return true;
+}
+
+bool MLTKEventQueue::pop(MLTKEvent &event){
+  const size_t h = head.load(memory_order_relaxed);
+  if(h == tail.load(memory_order_acquire)) return false;
+  event = events[h];
+  head.store((h + 1) % events.size(), memory_order_release);
+  return true;
+}
+
+unsigned long long MLTKEventQueue::getDropped() const {
+  return dropped.load();
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef ofxMLTKEvents_h
+#define ofxMLTKEvents_h
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+using namespace std;
+
+// Something that happened at a precise point of the input stream: a beat,
+// an onset, a fault. sample counts from the first sample passed to
+// audioIn(), so events line up with the audio no matter when run() got to
+// them. Some events are predictions and lie slightly ahead of the newest
+// sample analysed.
+struct MLTKEvent {
+  const char *type = "";        // "beat", "onset", ... (static strings)
+  unsigned long long sample = 0;
+  double time = 0;              // sample in seconds
+  float value = 0;              // depends on the type: tempo, strength, ...
+};
+
+// Hands events from the analysis to the app without locks or allocation,
+// so it is safe to pop from the audio or render thread. There is one
+// producer, the thread calling run(), and one consumer. When the app
+// doesn't keep up the newest events are dropped and counted.
+class MLTKEventQueue {
+public:
+  MLTKEventQueue(size_t capacity=1024);
+
+  bool push(const MLTKEvent &event);
+  bool pop(MLTKEvent &event);
+
+  // Events lost because the queue was full
+  unsigned long long getDropped() const;
+
+protected:
+  vector<MLTKEvent> events;
+  atomic<size_t> head{0}, tail{0};
+  atomic<unsigned long long> dropped{0};
+};
+
+#endif /* ofxMLTKEvents_h */
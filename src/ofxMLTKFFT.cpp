@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "ofxMLTKFFT.h"
+
+#include <iostream>
+
+#include "types.h"
+#include "threading.h"
+
+// Essentia's FFTW algorithms create and destroy their plans under
+// FFTW::globalFFTWMutex. The planner is process-wide, so MLTK's planning
+// takes the same lock. The reference is weak: it's null when Essentia was
+// built with another FFT or isn't linked at all, as in mltkWisdom.
+#if defined(__GNUC__)
+#define MLTK_LABEL_(prefix) #prefix
+#define MLTK_LABEL(prefix) MLTK_LABEL_(prefix)
+extern essentia::ForcedMutex essentiaFFTWMutex
+  __asm__(MLTK_LABEL(__USER_LABEL_PREFIX__) "_ZN8essentia8standard4FFTW15globalFFTWMutexE") __attribute__((weak));
+static essentia::ForcedMutex *const essentiaPlannerMutex = &essentiaFFTWMutex;
+#else
+static essentia::ForcedMutex *const essentiaPlannerMutex = 0;
+#endif
+
+// MLTKFFT's own lock guards the plan cache, Essentia's the FFTW planner
+class MLTKFFT::PlannerLock {
+public:
+  PlannerLock() : lock(MLTKFFT::mutex) { if(essentiaPlannerMutex) essentiaPlannerMutex->lock(); }
+  ~PlannerLock(){ if(essentiaPlannerMutex) essentiaPlannerMutex->unlock(); }
+protected:
+  std::lock_guard<std::mutex> lock;
+};
+
+map<pair<int, int>, weak_ptr<const MLTKFFT::Plan> > MLTKFFT::plans;
+unsigned int MLTKFFT::flags = FFTW_ESTIMATE;
+std::mutex MLTKFFT::mutex;
+
+MLTKFFT::Plan::~Plan(){
+  PlannerLock lock;
+  fftwf_destroy_plan(plan);
+}
+
+void MLTKFFT::Plan::execute(float *in, fftwf_complex *out) const {
+  fftwf_execute_dft_r2c(plan, in, out);
+}
+
+void MLTKFFT::Plan::execute(fftwf_complex *in, float *out) const {
+  fftwf_execute_dft_c2r(plan, in, out);
+}
+
+void MLTKFFT::Plan::execute(fftwf_complex *in, fftwf_complex *out) const {
+  fftwf_execute_dft(plan, in, out);
+}
+
+void MLTKFFT::setEffort(const string &effort){
+  std::lock_guard<std::mutex> lock(mutex);
+  if(effort == "measure") flags = FFTW_MEASURE;
+  else if(effort == "patient") flags = FFTW_PATIENT;
+  else if(effort == "exhaustive") flags = FFTW_EXHAUSTIVE;
+  else flags = FFTW_ESTIMATE;
+}
+
+string MLTKFFT::getEffort(){
+  std::lock_guard<std::mutex> lock(mutex);
+  if(flags == FFTW_MEASURE) return "measure";
+  if(flags == FFTW_PATIENT) return "patient";
+  if(flags == FFTW_EXHAUSTIVE) return "exhaustive";
+  return "estimate";
+}
+
+MLTKFFT::Handle MLTKFFT::plan(int size, Type type){
+  PlannerLock lock;
+
+  weak_ptr<const Plan> &cached = plans[make_pair(size, (int) type)];
+  Handle p = cached.lock();
+  if(p) return p;
+
+  // measuring plans overwrite their arrays, so they get scratch buffers of
+  // the same alignment the callers use
+  const int complexSize = (type == REAL_FORWARD || type == REAL_INVERSE) ? size / 2 + 1 : size;
+  float *real = (float*) fftwf_malloc(sizeof(float) * size);
+  fftwf_complex *complex = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * complexSize);
+  fftwf_complex *complex2 = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * complexSize);
+
+  fftwf_plan plan;
+  switch(type){
+    case REAL_FORWARD:
+      plan = fftwf_plan_dft_r2c_1d(size, real, complex, flags);
+      break;
+    case REAL_INVERSE:
+      plan = fftwf_plan_dft_c2r_1d(size, complex, real, flags);
+      break;
+    case COMPLEX_FORWARD:
+      plan = fftwf_plan_dft_1d(size, complex, complex2, FFTW_FORWARD, flags);
+      break;
+    default:
+      plan = fftwf_plan_dft_1d(size, complex, complex2, FFTW_BACKWARD, flags);
+      break;
+  }
+
+  fftwf_free(real);
+  fftwf_free(complex);
+  fftwf_free(complex2);
+
+  p = Handle(new Plan(size, type, plan));
+  cached = p;
+  return p;
+}
+
+float* MLTKFFT::allocReal(int n){
+  return (float*) fftwf_malloc(sizeof(float) * n);
+}
+
+fftwf_complex* MLTKFFT::allocComplex(int n){
+  return (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * n);
+}
+
+void MLTKFFT::free(void *buffer){
+  fftwf_free(buffer);
+}
+
+bool MLTKFFT::loadWisdom(const string &fileName){
+  PlannerLock lock;
+  return fftwf_import_wisdom_from_filename(fileName.c_str()) != 0;
+}
+
+bool MLTKFFT::saveWisdom(const string &fileName){
+  PlannerLock lock;
+  return fftwf_export_wisdom_to_filename(fileName.c_str()) != 0;
+}
+
+void MLTKFFT::train(const vector<int> &sizes, const string &effort){
+  string previous = getEffort();
+  setEffort(effort);
+
+  for(int size : sizes){
+    cout << "-------- planning " << size << " point FFTs (" << effort << ") --------" << endl;
+    // planned and dropped right away, what remains is the wisdom
+    for(int type = REAL_FORWARD; type <= COMPLEX_INVERSE; type++){
+      plan(size, (Type) type);
+    }
+  }
+
+  setEffort(previous);
+}
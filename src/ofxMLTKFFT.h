@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef ofxMLTKFFT_h
+#define ofxMLTKFFT_h
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "fftw3.h"
+
+using namespace std;
+
+// FFTW plans shared by every MLTK algorithm and instance, plus persistent
+// wisdom.
+//
+// There is one plan per (size, type). Plans are executed through FFTW's
+// new-array interface, which is thread-safe, so any number of algorithms
+// can run the same plan at once on their own buffers. Those buffers must
+// come from alloc() (or fftwf_malloc) so their alignment matches the plan.
+// Planning itself isn't thread-safe in FFTW. It goes through one lock,
+// the one Essentia's FFTW algorithms plan under when Essentia uses FFTW.
+//
+// Wisdom is FFTW's process-wide memory of the fastest algorithms. Measuring
+// it once at install time (see headlessBenchmark's mltkWisdom tool) and
+// loading it at startup turns every later MLTKFFT plan into a lookup.
+// Whether Essentia's own FFT algorithms see it too depends on how Essentia
+// was built and linked, and hasn't been verified.
+class MLTKFFT {
+public:
+  enum Type { REAL_FORWARD, REAL_INVERSE, COMPLEX_FORWARD, COMPLEX_INVERSE };
+
+  class Plan {
+  public:
+    const int size;
+    const Type type;
+
+    Plan(int size, Type type, fftwf_plan plan) : size(size), type(type), plan(plan) {}
+    ~Plan();
+
+    // REAL_FORWARD: size reals in, size/2+1 complex out
+    void execute(float *in, fftwf_complex *out) const;
+    // REAL_INVERSE: size/2+1 complex in, size reals out (unnormalized)
+    void execute(fftwf_complex *in, float *out) const;
+    // COMPLEX_FORWARD/INVERSE: size complex in and out (unnormalized)
+    void execute(fftwf_complex *in, fftwf_complex *out) const;
+
+  protected:
+    fftwf_plan plan;
+  };
+  typedef shared_ptr<const Plan> Handle;
+
+  // Planner rigor for new plans: estimate (default), measure, patient or
+  // exhaustive. Anything above estimate should normally only be used to
+  // build wisdom, see train().
+  static void setEffort(const string &effort);
+  static string getEffort();
+
+  // The shared plan for this size and type, planned on first use
+  static Handle plan(int size, Type type);
+
+  // SIMD aligned buffers to execute plans on
+  static float* allocReal(int n);
+  static fftwf_complex* allocComplex(int n);
+  static void free(void *buffer);
+
+  // Returns false if the file can't be read/written
+  static bool loadWisdom(const string &fileName);
+  static bool saveWisdom(const string &fileName);
+
+  // Plans every type for these sizes at the given effort, so saveWisdom()
+  // afterwards stores the result for later runs
+  static void train(const vector<int> &sizes, const string &effort="patient");
+
+protected:
+  // holds mutex and Essentia's FFTW planner lock
+  class PlannerLock;
+
+  static map<pair<int, int>, weak_ptr<const Plan> > plans;
+  static unsigned int flags;
+  static std::mutex mutex;
+};
+
+#endif /* ofxMLTKFFT_h */
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "ofxMLTKInputRing.h"
+
+#include <algorithm>
+
+void MLTKInputRing::setup(int capacity){
+  ready = false;
+  samples.assign(max(1, capacity), 0.0f);
+  claimed = 0;
+  written = 0;
+  ready = true;
+}
+
+void MLTKInputRing::write(const float *input, int numFrames, int numChannels){
+  if(!ready.load(memory_order_acquire) || numFrames <= 0 || numChannels <= 0) return;
+  const unsigned long long capacity = samples.size();
+  const unsigned long long first = written.load(memory_order_relaxed);
+
+  // the claim has to be visible before any slot is overwritten
+  claimed.store(first + numFrames, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  for(int i = 0; i < numFrames; i++){
+    float sample = 0.0f;
+    for(int c = 0; c < numChannels; c++){
+      sample += input[i * numChannels + c];
+    }
+    samples[(first + i) % capacity] = sample / numChannels;
+  }
+  written.store(first + numFrames, memory_order_release);
+}
+
+unsigned long long MLTKInputRing::getWritten() const {
+  return written.load(memory_order_acquire);
+}
+
+bool MLTKInputRing::read(unsigned long long position, int count, float *output) const {
+  const unsigned long long capacity = samples.size();
+  for(int i = 0; i < count; i++){
+    output[i] = samples[(position + i) % capacity];
+  }
+
+  // position's slot is reused for position + capacity, so anything the
+  // writer claimed past that may have overwritten part of the copy
+  atomic_thread_fence(memory_order_acquire);
+  return claimed.load(memory_order_relaxed) <= position + capacity;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef ofxMLTKInputRing_h
+#define ofxMLTKInputRing_h
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+using namespace std;
+
+// Hands device blocks from the sound card's input callback to the thread
+// calling run(), without locks or allocation on either side. The writer
+// mixes each block to mono and appends it; the reader copies frames out
+// by their position in the stream.
+//
+// The ring only holds capacity samples, so a reader that falls behind can
+// have the oldest samples of a copy overwritten while it makes it. The
+// writer claims the slots it is about to fill before touching them, and
+// read() checks the claim after copying, so a torn copy is reported rather
+// than analysed. There is one writer, the thread calling audioIn(), and
+// one reader.
+class MLTKInputRing {
+public:
+  // Allocates the ring and forgets everything written, not to be called
+  // while the input callback runs
+  void setup(int capacity);
+
+  // Appends numFrames interleaved frames, averaged over the channels
+  void write(const float *input, int numFrames, int numChannels);
+
+  // Samples written since setup()
+  unsigned long long getWritten() const;
+
+  // Copies count written samples from position on. Returns false if the
+  // writer lapped any of them during the copy.
+  bool read(unsigned long long position, int count, float *output) const;
+
+protected:
+  vector<float> samples;
+  atomic<bool> ready{false};
+
+  // the first position not claimed by the writer, and not written yet
+  atomic<unsigned long long> claimed{0}, written{0};
+};
+
+#endif /* ofxMLTKInputRing_h */
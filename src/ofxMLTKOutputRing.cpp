@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "ofxMLTKOutputRing.h"
+
+#include <algorithm>
+
+void MLTKOutputRing::setup(int capacity, int latency){
+  ready = false;
+  samples.assign(max(1, capacity), 0.0f);
+  this->latency = latency;
+  played = 0;
+  position = 0;
+  underruns = 0;
+  overruns = 0;
+  clear();
+  ready = true;
+}
+
+void MLTKOutputRing::clear(){
+  committed.store(0, memory_order_release);
+  end = 0;
+  fill(samples.begin(), samples.end(), 0.0f);
+}
+
+void MLTKOutputRing::extend(unsigned long long to){
+  const unsigned long long capacity = samples.size();
+  if(to <= end) return;
+  // slots that lap the reader can't be zeroed yet, and anything older
+  // than a lap would be overwritten anyway
+  to = min(to, position.load(memory_order_acquire) + capacity);
+  for(unsigned long long p = max(end, to > capacity ? to - capacity : 0); p < to; p++){
+    samples[p % capacity] = 0;
+  }
+  end = max(end, to);
+}
+
+void MLTKOutputRing::add(unsigned long long at, const float *x, int count){
+  const unsigned long long capacity = samples.size();
+  const unsigned long long first = committed.load(memory_order_relaxed);
+  const unsigned long long limit = position.load(memory_order_acquire) + capacity;
+  extend(at + count);
+
+  int skipped = 0;
+  for(int i = 0; i < count; i++){
+    const unsigned long long p = at + i;
+    if(p < first) continue;
+    if(p >= limit){
+      skipped++;
+      continue;
+    }
+    samples[p % capacity] += x[i];
+  }
+  if(skipped > 0) overruns += skipped;
+}
+
+void MLTKOutputRing::commit(unsigned long long to){
+  if(to <= committed.load(memory_order_relaxed)) return;
+  extend(to);
+  committed.store(min(to, end), memory_order_release);
+}
+
+void MLTKOutputRing::read(float *output, int numFrames, int numChannels){
+  if(!ready.load(memory_order_acquire)){
+    fill(output, output + numFrames * numChannels, 0.0f);
+    return;
+  }
+
+  const unsigned long long capacity = samples.size();
+  const unsigned long long available = committed.load(memory_order_acquire);
+  bool missing = false;
+  for(int i = 0; i < numFrames; i++){
+    // input position played by this output sample
+    const unsigned long long t = played + i;
+    float x = 0;
+    if(t >= (unsigned long long) latency){
+      const unsigned long long p = t - latency;
+      if(p < available && p + capacity >= available) x = samples[p % capacity];
+      else missing = true;
+    }
+    for(int c = 0; c < numChannels; c++) output[i * numChannels + c] = x;
+  }
+  played += numFrames;
+  if(played > (unsigned long long) latency){
+    position.store(played - latency, memory_order_release);
+  }
+  if(missing) underruns++;
+}
+
+int MLTKOutputRing::getLatency() const {
+  return latency;
+}
+
+unsigned long long MLTKOutputRing::getUnderruns() const {
+  return underruns.load();
+}
+
+unsigned long long MLTKOutputRing::getOverruns() const {
+  return overruns.load();
+}
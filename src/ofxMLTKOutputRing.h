@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef ofxMLTKOutputRing_h
+#define ofxMLTKOutputRing_h
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+using namespace std;
+
+// Hands synthesized audio from the analysis thread to the sound card's
+// output callback, without locks or allocation on either side. Samples are
+// addressed by their position in the input stream (see MLTKEvent), and the
+// output callback plays input position p exactly latency samples after the
+// input callback delivered it, as long as the two run in lockstep on one
+// duplex stream. Anything not synthesized by then plays as silence and is
+// counted, so the latency never drifts.
+//
+// The writer overlap-adds into the ring with add() and declares samples
+// final with commit(); the reader only ever sees committed samples. There
+// is one writer, the thread calling run(), and one reader.
+class MLTKOutputRing {
+public:
+  // Allocates the ring, not to be called while the output callback runs
+  void setup(int capacity, int latency);
+
+  // Forgets everything written so far, the reader's clock keeps running
+  void clear();
+
+  // Adds count samples at position. Samples already committed, or too far
+  // ahead of the reader for the ring, are left out.
+  void add(unsigned long long position, const float *samples, int count);
+
+  // Samples before position are final, those never added are silence
+  void commit(unsigned long long position);
+
+  // Plays the next numFrames samples into every channel of an interleaved
+  // buffer
+  void read(float *output, int numFrames, int numChannels);
+
+  int getLatency() const;
+
+  // Output blocks that had to play silence because the samples weren't
+  // committed in time
+  unsigned long long getUnderruns() const;
+
+  // Samples the writer had to leave out because the reader fell behind
+  unsigned long long getOverruns() const;
+
+protected:
+  vector<float> samples;
+  int latency = 0;
+  atomic<bool> ready{false};
+
+  // writer: the first position not zeroed for adding yet
+  unsigned long long end = 0;
+
+  // the first position not committed, and the first one not read yet
+  atomic<unsigned long long> committed{0}, position{0};
+
+  // reader: samples played since setup()
+  unsigned long long played = 0;
+
+  atomic<unsigned long long> underruns{0}, overruns{0};
+
+  // Zeroes the ring up to position before the writer adds to it
+  void extend(unsigned long long to);
+};
+
+#endif /* ofxMLTKOutputRing_h */
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "ofxMLTKTables.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+#include "algorithmfactory.h"
+#include "essentiamath.h"
+
+map<string, MLTKTables::Entry> MLTKTables::entries;
+MLTKTables::Stats MLTKTables::stats;
+std::mutex MLTKTables::mutex;
+
+MLTKTables::Handle MLTKTables::get(const string &type, int size, Real sampleRate, const string &params,
+                                   const function<void(Table&)> &build){
+  ostringstream key;
+  key << type << "/" << size << "/" << sampleRate << "/" << params;
+
+  // tables are only built at configure time, so building under the lock
+  // keeps two instances from building the same table side by side
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // forget the tables nobody holds any more, the keys include sampleRate
+  // and the parameters, so every reconfiguration would leave one behind
+  for(map<string, Entry>::iterator it = entries.begin(); it != entries.end();){
+    if(it->second.table.expired()) it = entries.erase(it);
+    else ++it;
+  }
+
+  Entry &entry = entries[key.str()];
+  Handle table = entry.table.lock();
+  if(table){
+    stats.hits++;
+    stats.bytesSaved += table->size() * sizeof(Real);
+    stats.buildSecondsSaved += entry.buildSeconds;
+    return table;
+  }
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  Table *built = new Table();
+  build(*built);
+  entry.buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  const size_t bytes = built->size() * sizeof(Real);
+  stats.misses++;
+  stats.tables++;
+  stats.bytes += bytes;
+  stats.buildSeconds += entry.buildSeconds;
+
+  // the deleter keeps the live totals up to date when the last user lets go
+  table = Handle(built, [bytes](const Table *t){
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stats.tables--;
+      stats.bytes -= bytes;
+    }
+    delete t;
+  });
+  entry.table = table;
+  return table;
+}
+
+MLTKTables::Handle MLTKTables::window(const string &type, int size, bool normalized){
+  return get("window:" + type, size, 0, normalized ? "normalized" : "", [&](Table &w){
+    w.resize(size);
+
+    if(type == "hann" || type == "hamming"){
+      const double a0 = type == "hann" ? 0.5 : 0.53836;
+      for(int i = 0; i < size; i++){
+        w[i] = a0 - (1.0 - a0) * cos((2.0 * M_PI * i) / (size - 1.0));
+      }
+    } else if(type == "triangular"){
+      for(int i = 0; i < size; i++){
+        w[i] = 2.0 / size * (size / 2.0 - fabs(i - (size - 1.0) / 2.0));
+      }
+    } else if(type.compare(0, 14, "blackmanharris") == 0){
+      double a0, a1, a2, a3;
+      if(type == "blackmanharris62"){      a0 = .44959; a1 = .49364; a2 = .05677; a3 = 0; }
+      else if(type == "blackmanharris70"){ a0 = .42323; a1 = .49755; a2 = .07922; a3 = 0; }
+      else if(type == "blackmanharris74"){ a0 = .40217; a1 = .49703; a2 = .09892; a3 = .00188; }
+      else {                                a0 = .35875; a1 = .48829; a2 = .14128; a3 = .01168; }
+      const double c = 2.0 * M_PI / (size - 1);
+      for(int i = 0; i < size; i++){
+        w[i] = a0 - a1 * cos(c * i) + a2 * cos(c * 2 * i) - a3 * cos(c * 3 * i);
+      }
+    } else {
+      // square
+      for(int i = 0; i < size; i++) w[i] = 1.0;
+    }
+
+    if(normalized){
+      double sum = 0;
+      for(int i = 0; i < size; i++) sum += w[i];
+      if(sum != 0) for(int i = 0; i < size; i++) w[i] *= 2.0 / sum;
+    }
+  });
+}
+
+MLTKTables::Handle MLTKTables::dct(int inputSize, int outputSize){
+  ostringstream params;
+  params << outputSize;
+  return get("dct2", inputSize, 0, params.str(), [&](Table &t){
+    t.resize(outputSize * inputSize);
+    const double scale0 = 1.0 / sqrt((double) inputSize);
+    const double scale1 = sqrt(2.0 / inputSize);
+    for(int i = 0; i < outputSize; i++){
+      const double scale = i == 0 ? scale0 : scale1;
+      const double frequency = i * M_PI / inputSize;
+      for(int j = 0; j < inputSize; j++){
+        t[i * inputSize + j] = scale * cos(frequency * (j + 0.5));
+      }
+    }
+  });
+}
+
+MLTKTables::Handle MLTKTables::filterbank(const string &algorithm, int inputSize, Real sampleRate, int numberBands,
+                                          Real lowFrequencyBound, Real highFrequencyBound, const string &type){
+  ostringstream params;
+  params << numberBands << "/" << lowFrequencyBound << "/" << highFrequencyBound << "/" << type;
+  return get("filterbank:" + algorithm, inputSize, sampleRate, params.str(), [&](Table &t){
+    essentia::standard::Algorithm *a = essentia::standard::AlgorithmFactory::create(algorithm,
+                                                                                  "inputSize", inputSize,
+                                                                                  "sampleRate", sampleRate,
+                                                                                  "numberBands", numberBands,
+                                                                                  "lowFrequencyBound", lowFrequencyBound,
+                                                                                  "highFrequencyBound", highFrequencyBound,
+                                                                                  "type", type);
+    vector<Real> spectrum(inputSize, 0), bands, coefficients;
+    string coefficientsName = algorithm;
+    transform(coefficientsName.begin(), coefficientsName.end(), coefficientsName.begin(), ::tolower);
+    a->input("spectrum").set(spectrum);
+    a->output("bands").set(bands);
+    a->output(coefficientsName).set(coefficients);
+
+    // the band energies are linear in the (squared) spectrum, so a unit
+    // spectrum at bin j gives the weights of column j
+    t.assign(numberBands * inputSize, 0);
+    for(int j = 0; j < inputSize; j++){
+      spectrum[j] = 1;
+      a->compute();
+      for(int i = 0; i < numberBands; i++){
+        t[i * inputSize + j] = bands[i];
+      }
+      spectrum[j] = 0;
+    }
+    delete a;
+  });
+}
+
+MLTKTables::Handle MLTKTables::constantQKernel(Real sampleRate, Real minFrequency, int binsPerOctave, int fftSize){
+  ostringstream params;
+  params << minFrequency << "/" << binsPerOctave;
+  return get("constantQKernel", fftSize, sampleRate, params.str(), [&](Table &t){
+    const int bins = fftSize / 2 + 1;
+    const double Q = 1.0 / (pow(2.0, 1.0 / binsPerOctave) - 1.0);
+    t.assign(binsPerOctave * bins * 2, 0);
+
+    vector<double> window;
+    for(int k = 0; k < binsPerOctave; k++){
+      const double frequency = minFrequency * pow(2.0, (double) k / binsPerOctave);
+      const int length = min(fftSize, (int) ceil(Q * sampleRate / frequency));
+
+      // hann window normalized to a sum of 1, so a sinusoid of amplitude A
+      // at the bin's frequency comes out as A/2
+      window.resize(length);
+      double sum = 0;
+      for(int n = 0; n < length; n++){
+        window[n] = 0.5 - 0.5 * cos(2.0 * M_PI * (n + 0.5) / length);
+        sum += window[n];
+      }
+
+      // conj(DFT(kernel)) / fftSize, so that sum_j X[j] * K[j] is the inner
+      // product of the frame with the kernel. Real frames only need the
+      // positive frequencies, where the kernel's energy is.
+      const int offset = fftSize - length;
+      const double omega = 2.0 * M_PI * frequency / sampleRate;
+      for(int j = 0; j < bins; j++){
+        double re = 0, im = 0;
+        for(int n = 0; n < length; n++){
+          const double phase = omega * n - 2.0 * M_PI * (double) j * (offset + n) / fftSize;
+          re += window[n] / sum * cos(phase);
+          im += window[n] / sum * sin(phase);
+        }
+        t[(k * bins + j) * 2] = re / fftSize;
+        t[(k * bins + j) * 2 + 1] = -im / fftSize;
+      }
+    }
+  });
+}
+
+MLTKTables::Handle MLTKTables::tonalProfiles(const string &type){
+  return get("tonalProfiles:" + type, 12, 0, "", [&](Table &t){
+    // tonic first
+    static const double krumhansl[2][12] = {
+      { 6.35, 2.23, 3.48, 2.33, 4.38, 4.09, 2.52, 5.19, 2.39, 3.66, 2.29, 2.88 },
+      { 6.33, 2.68, 3.52, 5.38, 2.60, 3.53, 2.54, 4.75, 3.98, 2.69, 3.34, 3.17 } };
+    static const double temperley[2][12] = {
+      { 5.0, 2.0, 3.5, 2.0, 4.5, 4.0, 2.0, 4.5, 2.0, 3.5, 1.5, 4.0 },
+      { 5.0, 2.0, 3.5, 4.5, 2.0, 4.0, 2.0, 4.5, 3.5, 2.0, 1.5, 4.0 } };
+    static const double triads[2][12] = {
+      { 1, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0 },
+      { 1, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 0 } };
+    const double (*profile)[12] = type == "temperley" ? temperley : type == "triads" ? triads : krumhansl;
+
+    t.resize(24 * 12);
+    for(int scale = 0; scale < 2; scale++){
+      double mean = 0, norm = 0;
+      for(int i = 0; i < 12; i++) mean += profile[scale][i] / 12;
+      for(int i = 0; i < 12; i++) norm += (profile[scale][i] - mean) * (profile[scale][i] - mean);
+      norm = sqrt(norm);
+      for(int tonic = 0; tonic < 12; tonic++){
+        for(int i = 0; i < 12; i++){
+          t[(scale * 12 + tonic) * 12 + (tonic + i) % 12] = (profile[scale][i] - mean) / norm;
+        }
+      }
+    }
+  });
+}
+
+MLTKTables::Stats MLTKTables::getStats(){
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+void MLTKTables::printStats(){
+  Stats s = getStats();
+  cout << "-------- DSP tables: " << s.tables << " shared, "
+       << s.bytes / 1024 << " KB, "
+       << s.hits << " hits / " << s.misses << " built, "
+       << s.bytesSaved / 1024 << " KB and "
+       << 1e3 * s.buildSecondsSaved << " ms of setup saved --------" << endl;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef ofxMLTKTables_h
+#define ofxMLTKTables_h
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "types.h"
+
+using namespace std;
+using namespace essentia;
+
+// Process-wide cache of immutable DSP tables (windows, DCT matrices,
+// filterbanks, spectral kernels) shared by MLTK's own algorithms across
+// every instance and channel.
+//
+// Tables are keyed by (type, size, sampleRate, params) and handed out as
+// shared pointers to const data. The cache only keeps weak references, so
+// a table is freed as soon as the last algorithm using it is deleted, and
+// rebuilt on the next request.
+//
+// Essentia's own algorithms are precompiled and keep building their tables
+// privately, this only covers the kernels in src/algorithms.
+class MLTKTables {
+public:
+  typedef vector<Real> Table;
+  typedef shared_ptr<const Table> Handle;
+
+  struct Stats {
+    size_t tables = 0;                  // alive right now
+    size_t bytes = 0;                   // held by them
+    size_t bytesSaved = 0;              // by requests served from the cache
+    double buildSeconds = 0;            // spent building tables
+    double buildSecondsSaved = 0;       // not spent thanks to the cache
+    unsigned long long hits = 0, misses = 0;
+  };
+
+  // Returns the table for the key, calling build to fill it in if no one
+  // holds it at the moment. params must describe everything else build
+  // depends on.
+  static Handle get(const string &type, int size, Real sampleRate, const string &params,
+                    const function<void(Table&)> &build);
+
+  // Windowing's windows: hann, hamming, triangular, square and
+  // blackmanharris62/70/74/92, normalized to a sum of 2 like Windowing's
+  // "normalized" parameter
+  static Handle window(const string &type, int size, bool normalized=true);
+
+  // DCT-II matrix as used by MFCC/BFCC/GFCC (DCT with dctType 2), row major
+  // with outputSize rows of inputSize values
+  static Handle dct(int inputSize, int outputSize);
+
+  // The band weights of Essentia's MFCC, BFCC or GFCC filterbank with their
+  // default warping and normalization, row major with numberBands rows of
+  // inputSize values. They are read back from the algorithm itself, one
+  // unit spectrum per bin, so they match whatever Essentia computes.
+  static Handle filterbank(const string &algorithm, int inputSize, Real sampleRate, int numberBands,
+                           Real lowFrequencyBound, Real highFrequencyBound, const string &type="power");
+
+  // Spectral kernel of one constant-Q octave (Brown & Puckette), whose
+  // lowest bin is minFrequency. Each bin is a hann windowed complex
+  // exponential of Q periods, right aligned in the fftSize frame so the
+  // short kernels of the high bins only wait for the newest samples. Stored
+  // as binsPerOctave rows of fftSize/2+1 interleaved re/im values, ready to
+  // be multiplied with the real FFT of the frame.
+  static Handle constantQKernel(Real sampleRate, Real minFrequency, int binsPerOctave, int fftSize);
+
+  // Pitch class templates of the 24 major and minor keys (krumhansl,
+  // temperley) or tonic triads (triads), with the first bin on A like
+  // HPCP's. 24 rows of 12 values, the 12 major ones then the 12 minor ones
+  // rooted on A, Bb, ..., Ab, each shifted to zero mean and scaled to unit
+  // norm, so a row's dot product with a mean free profile over that
+  // profile's norm is their correlation.
+  static Handle tonalProfiles(const string &type);
+
+  static Stats getStats();
+  static void printStats();
+
+protected:
+  struct Entry {
+    weak_ptr<const Table> table;
+    double buildSeconds;
+  };
+
+  static map<string, Entry> entries;
+  static Stats stats;
+  static std::mutex mutex;
+};
+
+#endif /* ofxMLTKTables_h */
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#include "ofxMLTKTimeline.h"
+#include "ofxMLTKEngine.h"
+#include "algorithms/MLTKChunkedLoader.h"
+#include "scheduler/network.h"
+
+#include <cmath>
+#include <iostream>
+
+MLTKTimeline::~MLTKTimeline(){
+  stop();
+}
+
+void MLTKTimeline::setup(const string &fileName){
+  stop();
+
+  if(!MLTKChunkedLoader::canOpen(fileName)){
+    throw EssentiaException("MLTKTimeline: can't seek in ", fileName, ", only formats read by libsndfile are supported");
+  }
+
+  this->fileName = fileName;
+
+  if(!acquired) MLTKEngine::acquire();
+  acquired = true;
+
+  {
+    MLTKChunkedLoader loader;
+    loader.configure("filename", fileName, "sampleRate", sampleRate);
+    numberOfSamples = loader.numberOfSamples();
+  }
+
+  // with frames starting at zero, frame n covers [n * hopSize, n * hopSize + frameSize)
+  // and the last one is the first frame reaching the end of the file
+  if(numberOfSamples <= frameSize){
+    numberOfFrames = 1;
+  } else {
+    numberOfFrames = (int) ((numberOfSamples - frameSize + hopSize - 1) / hopSize) + 1;
+  }
+  framesPerRegion = max(1, (int) (regionLength * sampleRate / hopSize));
+
+  {
+    std::lock_guard<std::mutex> lock(regionMutex);
+    regions.assign((numberOfFrames + framesPerRegion - 1) / framesPerRegion, PENDING);
+    regionsDone = 0;
+    playheadRegion = 0;
+  }
+  {
+    std::lock_guard<std::mutex> lock(descriptorMutex);
+    descriptors.clear();
+  }
+
+  int n = numberOfThreads > 0 ? numberOfThreads : (int) std::thread::hardware_concurrency() - 1;
+  if(n < 1) n = 1;
+
+  stopping = false;
+  for(int i = 0; i < n; i++){
+    workers.push_back(std::thread(&MLTKTimeline::worker, this));
+  }
+}
+
+void MLTKTimeline::stop(){
+  stopping = true;
+  for(std::thread &t : workers){
+    t.join();
+  }
+  workers.clear();
+
+  if(acquired) MLTKEngine::release();
+  acquired = false;
+}
+
+void MLTKTimeline::setPlayhead(float seconds){
+  std::lock_guard<std::mutex> lock(regionMutex);
+  playheadRegion = frameAt(seconds) / framesPerRegion;
+}
+
+float MLTKTimeline::getDuration(){
+  return (float) numberOfSamples / sampleRate;
+}
+
+float MLTKTimeline::getProgress(){
+  std::lock_guard<std::mutex> lock(regionMutex);
+  if(regions.empty()) return 0.0;
+  return (float) regionsDone / regions.size();
+}
+
+bool MLTKTimeline::isAnalyzed(float seconds){
+  std::lock_guard<std::mutex> lock(regionMutex);
+  int region = frameAt(seconds) / framesPerRegion;
+  return region < (int) regions.size() && regions[region] == DONE;
+}
+
+bool MLTKTimeline::exists(const string &descriptor){
+  std::lock_guard<std::mutex> lock(descriptorMutex);
+  return descriptors.count(descriptor) > 0;
+}
+
+vector<Real> MLTKTimeline::getData(const string &descriptor, float seconds){
+  if(!isAnalyzed(seconds)) return vector<Real>();
+
+  std::lock_guard<std::mutex> lock(descriptorMutex);
+  map<string, vector<vector<Real> > >::iterator it = descriptors.find(descriptor);
+  if(it == descriptors.end()) return vector<Real>();
+  return it->second[frameAt(seconds)];
+}
+
+Real MLTKTimeline::getValue(const string &descriptor, float seconds){
+  vector<Real> value = getData(descriptor, seconds);
+  return value.empty() ? 0.0 : value[0];
+}
+
+// The newest frame that is complete at this position
+int MLTKTimeline::frameAt(float seconds){
+  long long sample = (long long) (seconds * sampleRate);
+  int frame = sample < frameSize ? 0 : (int) ((sample - frameSize) / hopSize);
+  return min(max(frame, 0), max(numberOfFrames - 1, 0));
+}
+
+// Pending region closest to the playhead, looking ahead of it first since
+// that is where playback is going
+int MLTKTimeline::nextRegion(){
+  std::lock_guard<std::mutex> lock(regionMutex);
+  int best = -1, bestCost = 0;
+  for(int r = 0; r < (int) regions.size(); r++){
+    if(regions[r] != PENDING) continue;
+    int distance = r - playheadRegion;
+    int cost = distance >= 0 ? distance : -2 * distance;
+    if(best < 0 || cost < bestCost){
+      best = r;
+      bestCost = cost;
+    }
+  }
+  if(best >= 0) regions[best] = ANALYZING;
+  return best;
+}
+
+void MLTKTimeline::worker(){
+  while(!stopping){
+    int region = nextRegion();
+    if(region < 0) break;
+
+    try {
+      analyze(region);
+    } catch (std::exception &e) {
+      cerr << "MLTKTimeline: " << fileName << ": " << e.what() << endl;
+    }
+
+    // failed regions are marked done too, so they aren't retried forever
+    std::lock_guard<std::mutex> lock(regionMutex);
+    regions[region] = DONE;
+    regionsDone++;
+  }
+}
+
+void MLTKTimeline::analyze(int region){
+  const int first = region * framesPerRegion;
+  const int last = min(first + framesPerRegion, numberOfFrames);
+
+  Pool pool;
+  analyzeFrames(fileName, first, last, pool, chain, sampleRate, frameSize, hopSize, leadIn, 4.0);
+
+  const map<string, vector<Real> > &reals = pool.getRealPool();
+  for(map<string, vector<Real> >::const_iterator it = reals.begin(); it != reals.end(); ++it){
+    for(int i = 0; i < (int) it->second.size(); i++){
+      store(it->first, first + i, vector<Real>(1, it->second[i]));
+    }
+  }
+
+  const map<string, vector<vector<Real> > > &vectors = pool.getVectorRealPool();
+  for(map<string, vector<vector<Real> > >::const_iterator it = vectors.begin(); it != vectors.end(); ++it){
+    for(int i = 0; i < (int) it->second.size(); i++){
+      store(it->first, first + i, it->second[i]);
+    }
+  }
+}
+
+void MLTKTimeline::store(const string &descriptor, int frame, const vector<Real> &value){
+  std::lock_guard<std::mutex> lock(descriptorMutex);
+  vector<vector<Real> > &frames = descriptors[descriptor];
+  if(frames.empty()) frames.resize(numberOfFrames);
+  frames[frame] = value;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2019 Michael Simpson [https://mgs.nyc/]
+ *
+ * ofxMLTK is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation (FSF), either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the Affero GNU General Public License
+ * version 3 along with this program.  If not, see http://www.gnu.org/licenses/
+ *
+ * ---------------------------------------------------------------
+ *
+ * This project uses Essentia, copyrighted by Music Technology Group - Universitat Pompeu Fabra
+ * using GNU Affero General Public License.
+ * See http://essentia.upf.edu for documentation.
+ *
+ */
+
+#ifndef ofxMLTKTimeline_h
+#define ofxMLTKTimeline_h
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ofxMLTKChain.h"
+
+using namespace std;
+using namespace essentia;
+using namespace streaming;
+
+// Analyses a whole file in the background, as fast as the CPU allows, into
+// a time-indexed descriptor timeline.
+//
+// The file is split into regions that worker threads analyse independently
+// (each one decoding its own slice with MLTKChunkedLoader), always picking
+// the pending region closest to the playhead first, so seeking anywhere is
+// instant as soon as that region is done. Every region is preceded by a
+// short lead-in that is analysed and thrown away, so stateful algorithms
+// (DCRemoval, filters, ...) are warmed up at the region boundary.
+//
+// Playback and visuals then only look descriptors up at the playhead.
+class MLTKTimeline {
+public:
+  int sampleRate = 44100;
+  int frameSize = 2048;
+  int hopSize = 1024;
+
+  // 0 leaves one hardware thread to the app and uses the rest
+  int numberOfThreads = 0;
+
+  // Seconds analysed per job, and seconds of warm-up before each region
+  float regionLength = 10;
+  float leadIn = 2;
+
+  // Leave empty to use connectDefaultChain(), must produce one token per
+  // hop for every descriptor
+  MLTKChain chain;
+
+  ~MLTKTimeline();
+
+  // Starts analysing the file in the background
+  void setup(const string &fileName);
+  void stop();
+
+  // Moves the analysis priority to this position
+  void setPlayhead(float seconds);
+
+  float getDuration();
+  float getProgress();
+  bool isAnalyzed(float seconds);
+  bool exists(const string &descriptor);
+
+  // Descriptor values of the frame at the given position, empty (or 0.0)
+  // until that region has been analysed
+  vector<Real> getData(const string &descriptor, float seconds);
+  Real getValue(const string &descriptor, float seconds);
+
+protected:
+  string fileName;
+  long long numberOfSamples = 0;
+  int numberOfFrames = 0;
+  int framesPerRegion = 1;
+
+  enum RegionState { PENDING, ANALYZING, DONE };
+  vector<RegionState> regions;
+  int playheadRegion = 0;
+  int regionsDone = 0;
+  std::mutex regionMutex;
+
+  // descriptor name -> one value vector per frame
+  map<string, vector<vector<Real> > > descriptors;
+  std::mutex descriptorMutex;
+
+  vector<std::thread> workers;
+  atomic<bool> stopping{false};
+  bool acquired = false;
+
+  int frameAt(float seconds);
+  int nextRegion();
+  void worker();
+  void analyze(int region);
+  void store(const string &descriptor, int frame, const vector<Real> &value);
+};
+
+#endif /* ofxMLTKTimeline_h */